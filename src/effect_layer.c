@@ -2,6 +2,13 @@
 #include "effect_layer.h"
 #include "effects.h"  
 
+// number of lens effects on all effect layers, the lens table cached by effects.c is released with the last one
+static uint16_t s_lens_effects = 0;
+
+static void lens_effect_removed() {
+  if(--s_lens_effects == 0) effect_lens_release();
+}
+
 // Find the offset of parent layer pointer  
 static uint8_t find_parent_offset() {
   Layer* p = layer_create(GRect(0,0,32,32));
@@ -21,6 +28,49 @@ static uint8_t find_parent_offset() {
   return i;
 }
 
+#ifdef EFFECT_LAYER_PROFILE
+// adds call of effect slot (and fused-1 following ones) to per slot totals and to the ring buffer
+static void profile_record(EffectLayer *effect_layer, uint8_t slot, uint8_t fused, GRect frame, uint32_t ms) {
+  EffectLayerProfile *profile = &effect_layer->profile;
+  uint32_t pixels = (uint32_t)frame.size.w * frame.size.h;
+  
+  for(uint8_t i=slot; i<slot+fused; ++i) {
+    profile->calls[i]++;
+    profile->pixels[i] += pixels;
+    profile->ms[i] += ms; // fused effects share the time of the single pass
+  }
+  
+  EffectLayerProfileRecord *record = &profile->records[profile->next_record];
+  record->effect = effect_layer->effects[slot];
+  record->slot = slot;
+  record->fused = fused;
+  record->pixels = pixels;
+  record->ms = ms;
+  profile->next_record = (profile->next_record + 1) % EFFECT_LAYER_PROFILE_RECORDS;
+  if(profile->count < EFFECT_LAYER_PROFILE_RECORDS) profile->count++;
+}
+
+//logs profiler totals and recorded calls (oldest first)
+void effect_layer_profile_dump(EffectLayer *effect_layer) {
+  EffectLayerProfile *profile = &effect_layer->profile;
+  
+  for(uint8_t i=0; i<MAX_EFFECTS && effect_layer->effects[i]; ++i)
+    APP_LOG(APP_LOG_LEVEL_INFO, "effect %d (%p): %d calls, %d pixels, %d ms", i, effect_layer->effects[i],
+            (int)profile->calls[i], (int)profile->pixels[i], (int)profile->ms[i]);
+  
+  for(uint8_t n=0; n<profile->count; ++n) {
+    EffectLayerProfileRecord *record = &profile->records[(profile->next_record + EFFECT_LAYER_PROFILE_RECORDS - profile->count + n) % EFFECT_LAYER_PROFILE_RECORDS];
+    APP_LOG(APP_LOG_LEVEL_INFO, "call %d: effect %d (%p) x%d, %d pixels, %d ms", n, record->slot, record->effect,
+            record->fused, (int)record->pixels, (int)record->ms);
+  }
+}
+
+//clears profiler data
+void effect_layer_profile_reset(EffectLayer *effect_layer) {
+  memset(&effect_layer->profile, 0, sizeof(EffectLayerProfile));
+}
+#endif
+
 // on layer update - apply effect
 static void effect_layer_update_proc(Layer *me, GContext* ctx) {
   static uint8_t parent_layer_offset = 0xff;
@@ -38,8 +88,36 @@ static void effect_layer_update_proc(Layer *me, GContext* ctx) {
     layer_frame.origin.y += parent_frame.origin.y;
   }
   
-  // Applying effects
-  for(uint8_t i=0; effect_layer->effects[i] && i<MAX_EFFECTS;++i) effect_layer->effects[i](ctx, layer_frame, effect_layer->params[i]);
+  // Applying effects. Runs of consecutive per-pixel effects are composed into a single lut and applied
+  // with one framebuffer capture and one pass, other effects (blur, lens, mask...) are called as is.
+  static uint8_t lut[256], step_lut[256];
+  uint8_t i = 0;
+  while(i<MAX_EFFECTS && effect_layer->effects[i]) {
+    uint8_t fused = 1;
+    bool per_pixel = effect_get_lut(effect_layer->effects[i], effect_layer->params[i], lut);
+    while(per_pixel && i+fused<MAX_EFFECTS && effect_layer->effects[i+fused] && effect_get_lut(effect_layer->effects[i+fused], effect_layer->params[i+fused], step_lut)) {
+      for(int c=0; c<256; ++c) lut[c] = step_lut[lut[c]];
+      ++fused;
+    }
+    
+#ifdef EFFECT_LAYER_PROFILE
+    uint32_t start = clock_ms();
+#endif
+    if(fused == 1) {
+      // other effect or single per-pixel effect - it has its own fast path already
+      effect_layer->effects[i](ctx, layer_frame, effect_layer->params[i]);
+    } else {
+      GBitmap *fb = graphics_capture_frame_buffer(ctx);
+      BitmapInfo bitmap_info;
+      bitmap_info_init(&bitmap_info, fb);
+      effect_lut_apply(&bitmap_info, layer_frame, lut);
+      graphics_release_frame_buffer(ctx, fb);
+    }
+#ifdef EFFECT_LAYER_PROFILE
+    profile_record(effect_layer, i, fused, layer_frame, clock_ms() - start);
+#endif
+    i += fused;
+  }
 }  
 
 // create effect layer
@@ -59,9 +137,10 @@ EffectLayer* effect_layer_create(GRect frame) {
 void effect_layer_destroy(EffectLayer *effect_layer) {
   // precaution
   if (effect_layer != NULL && effect_layer->layer != NULL) {
+    for(uint8_t i=0; i<effect_layer->next_effect; ++i)
+      if(effect_layer->effects[i] == effect_lens) lens_effect_removed();
+    // effect_layer lives in the layer data, it is gone after this
     layer_destroy(effect_layer->layer);  
-    effect_layer->layer = NULL;
-    effect_layer = NULL;
   }
   
 }
@@ -82,12 +161,14 @@ void effect_layer_add_effect(EffectLayer *effect_layer, effect_cb* effect, void*
     effect_layer->effects[effect_layer->next_effect] = effect;
     effect_layer->params[effect_layer->next_effect] = param;  
     ++effect_layer->next_effect;
+    if(effect == effect_lens) ++s_lens_effects;
   }
 }
 
 //removes last added effect
 void effect_layer_remove_effect(EffectLayer *effect_layer) {
   if(effect_layer->next_effect > 0) {
+    if(effect_layer->effects[effect_layer->next_effect - 1] == effect_lens) lens_effect_removed();
     effect_layer->effects[effect_layer->next_effect - 1] = NULL;
     effect_layer->params[effect_layer->next_effect - 1] = NULL;  
     --effect_layer->next_effect;
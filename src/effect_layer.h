@@ -5,12 +5,39 @@
 //number of supported effects on a single effect_layer (must be <= 255)
 #define MAX_EFFECTS 4
   
+#ifdef EFFECT_LAYER_PROFILE
+//number of effect calls kept by the profiler
+#define EFFECT_LAYER_PROFILE_RECORDS 16
+
+// single profiled call - an effect or a fused run of per-pixel effects
+typedef struct {
+  effect_cb*  effect; // effect called (first one of a fused run)
+  uint8_t     slot; // index of the effect in the layer
+  uint8_t     fused; // number of effects applied by the call
+  uint32_t    pixels; // pixels of the layer rect
+  uint32_t    ms; // elapsed time
+} EffectLayerProfileRecord;
+
+// profiler data of effect layer (compiled in with EFFECT_LAYER_PROFILE defined)
+typedef struct {
+  uint32_t    calls[MAX_EFFECTS]; // calls per effect
+  uint32_t    pixels[MAX_EFFECTS]; // pixels touched per effect
+  uint32_t    ms[MAX_EFFECTS]; // elapsed time per effect
+  EffectLayerProfileRecord records[EFFECT_LAYER_PROFILE_RECORDS]; // last calls, ring buffer
+  uint8_t     next_record;
+  uint8_t     count;
+} EffectLayerProfile;
+#endif
+  
 // structure of effect layer
 typedef struct {
   Layer*      layer;
   effect_cb*  effects[MAX_EFFECTS];
   void*       params[MAX_EFFECTS];
   uint8_t     next_effect;
+#ifdef EFFECT_LAYER_PROFILE
+  EffectLayerProfile profile;
+#endif
 } EffectLayer;
 
 
@@ -32,6 +59,14 @@ Layer* effect_layer_get_layer(EffectLayer *effect_layer);
 //sets effect layer frame
 void effect_layer_set_frame(EffectLayer *effect_layer, GRect frame);
 
+#ifdef EFFECT_LAYER_PROFILE
+//logs per effect call counts, pixels and time and the last recorded calls over APP_LOG
+void effect_layer_profile_dump(EffectLayer *effect_layer);
+
+//clears profiler data
+void effect_layer_profile_reset(EffectLayer *effect_layer);
+#endif
+
 // Recreate inverter_layer for SDK 3
 #ifndef InverterLayer
   #define InverterLayer EffectLayer
@@ -6,52 +6,68 @@
 // { ********* Graphics utility functions (probablu should be seaparated into anothe file?) *********
   
   
-// set pixel color at given coordinates 
-void set_pixel(BitmapInfo bitmap_info, int y, int x, uint8_t color) {
+// fills bitmap info for given bitmap
+void bitmap_info_init(BitmapInfo *bitmap_info, GBitmap *bitmap) {
+  bitmap_info->bitmap = bitmap;
+  bitmap_info->bitmap_data =  gbitmap_get_data(bitmap);
+  bitmap_info->bytes_per_row = gbitmap_get_bytes_per_row(bitmap);
+  bitmap_info->bitmap_format = gbitmap_get_format(bitmap);
+  bitmap_info->bounds = gbitmap_get_bounds(bitmap);
+}
+
+// positions cursor at the beginning of row y
+void bitmap_row_begin(BitmapRow *row, BitmapInfo *bitmap_info, int y) {
+  row->info = bitmap_info;
+  row->y = y;
   
 #ifndef PBL_PLATFORM_APLITE  
-  if (bitmap_info.bitmap_format == GBitmapFormat1BitPalette) { // for 1bit palette bitmap on Basalt --- verify if it needs to be different
-     bitmap_info.bitmap_data[y*bitmap_info.bytes_per_row + x / 8] ^= (-color ^ bitmap_info.bitmap_data[y*bitmap_info.bytes_per_row + x / 8]) & (1 << (x % 8)); 
+  row->one_bit = bitmap_info->bitmap_format == GBitmapFormat1BitPalette;
 #else
-  if (bitmap_info.bitmap_format == GBitmapFormat1Bit) { // for 1 bit bitmap on Aplite  --- verify if it needs to be different
-     bitmap_info.bitmap_data[y*bitmap_info.bytes_per_row + x / 8] ^= (-color ^ bitmap_info.bitmap_data[y*bitmap_info.bytes_per_row + x / 8]) & (1 << (x % 8)); 
+  row->one_bit = bitmap_info->bitmap_format == GBitmapFormat1Bit;
 #endif
-  } else { // othersise (assuming GBitmapFormat8Bit) going byte-wise
-      
-     #ifndef PBL_PLATFORM_CHALK
-       bitmap_info.bitmap_data[y*bitmap_info.bytes_per_row + x] = color;
-     #else
-       GBitmapDataRowInfo info = gbitmap_get_data_row_info(bitmap_info.bitmap, y);
-       if ((x >= info.min_x) && (x <= info.max_x)) info.data[x] = color;
-     #endif  
-  
+
+  if (y < bitmap_info->bounds.origin.y || y >= bitmap_info->bounds.origin.y + bitmap_info->bounds.size.h) { // row outside of bitmap - nothing is valid
+    row->data = bitmap_info->bitmap_data;
+    row->min_x = 0;
+    row->max_x = -1;
+    return;
   }
-      
+  
+  #ifndef PBL_PLATFORM_CHALK
+    row->data = bitmap_info->bitmap_data + y*bitmap_info->bytes_per_row;
+    row->min_x = bitmap_info->bounds.origin.x;
+    row->max_x = bitmap_info->bounds.origin.x + bitmap_info->bounds.size.w - 1;
+  #else
+    if (row->one_bit || bitmap_info->bitmap_format == GBitmapFormat8Bit) { // rectangular bitmaps on Chalk (e.g. mask background)
+      row->data = bitmap_info->bitmap_data + y*bitmap_info->bytes_per_row;
+      row->min_x = bitmap_info->bounds.origin.x;
+      row->max_x = bitmap_info->bounds.origin.x + bitmap_info->bounds.size.w - 1;
+    } else {
+      GBitmapDataRowInfo info = gbitmap_get_data_row_info(bitmap_info->bitmap, y);
+      row->data = info.data;
+      row->min_x = info.min_x;
+      row->max_x = info.max_x;
+    }
+  #endif  
 }
 
-// get pixel color at given coordinates 
-uint8_t get_pixel(BitmapInfo bitmap_info, int y, int x) {
+// advances cursor to the next row
+void bitmap_row_next(BitmapRow *row) {
+  bitmap_row_begin(row, row->info, row->y + 1);
+}
 
-#ifndef PBL_PLATFORM_APLITE  
-  if (bitmap_info.bitmap_format == GBitmapFormat1BitPalette) { // for 1bit palette bitmap on Basalt shifting left to get correct bit
-    return (bitmap_info.bitmap_data[y*bitmap_info.bytes_per_row + x / 8] << (x % 8)) & 128;
-#else
-  if (bitmap_info.bitmap_format == GBitmapFormat1Bit) { // for 1 bit bitmap on Aplite - shifting right to get bit
-    return (bitmap_info.bitmap_data[y*bitmap_info.bytes_per_row + x / 8] >> (x % 8)) & 1;
-#endif
-  } else {  // othersise (assuming GBitmapFormat8Bit) going byte-wise
-    
-    #ifndef PBL_PLATFORM_CHALK
-       return bitmap_info.bitmap_data[y*bitmap_info.bytes_per_row + x]; 
-     #else
-       GBitmapDataRowInfo info = gbitmap_get_data_row_info(bitmap_info.bitmap, y);
-       if ((x >= info.min_x) && (x <= info.max_x))
-         return info.data[x];
-       else 
-         return -1;
-     #endif  
-  }
-  
+// set pixel color at given coordinates (random access - prefer BitmapRow when walking rows)
+void set_pixel(BitmapInfo bitmap_info, int y, int x, uint8_t color) {
+  BitmapRow row;
+  bitmap_row_begin(&row, &bitmap_info, y);
+  bitmap_row_set(&row, x, color);
+}
+
+// get pixel color at given coordinates (random access - prefer BitmapRow when walking rows)
+uint8_t get_pixel(BitmapInfo bitmap_info, int y, int x) {
+  BitmapRow row;
+  bitmap_row_begin(&row, &bitmap_info, y);
+  return bitmap_row_get(&row, x);
 }  
   
 
@@ -70,105 +86,6 @@ uint8_t PalColor(uint8_t in_color, GBitmapFormat in_format, GBitmapFormat out_fo
 }
  
 
-// THE EXTREMELY FAST LINE ALGORITHM Variation E (Addition Fixed Point PreCalc Small Display)
-// Small Display (256x256) resolution.
-// based on algorythm by Po-Han Lin at http://www.edepot.com
-void set_line(BitmapInfo bitmap_info, int y, int x, int y2, int x2, uint8_t draw_color, uint8_t skip_color, uint8_t *visited) {
-  bool yLonger = false; int shortLen=y2-y; int longLen=x2-x;
-  uint8_t temp_pixel;  int temp_x, temp_y;
-  
-  GRect bounds = gbitmap_get_bounds(bitmap_info.bitmap);
-  
-  if (abs(shortLen)>abs(longLen)) {
-    int swap=shortLen;
-    shortLen=longLen; longLen=swap; yLonger=true;
-  }
-  
-  int decInc;
-  if (longLen==0) decInc=0;
-  else decInc = (shortLen << 8) / longLen;
-
-  if (yLonger) {
-    if (longLen>0) {
-      longLen+=y;
-      for (int j=0x80+(x<<8);y<=longLen;++y) {
-        temp_y = y; temp_x = j >> 8;
-        if (temp_y >=bounds.origin.y && temp_y<bounds.size.h && temp_x >=bounds.origin.x && temp_x < bounds.size.w) {
-          temp_pixel = get_pixel(bitmap_info,  temp_y, temp_x);
-          #ifdef PBL_COLOR // for Basalt drawing pixel if it is not of original color or already drawn color
-            if (temp_pixel != skip_color && temp_pixel != draw_color) set_pixel(bitmap_info, temp_y, temp_x, draw_color);
-          #else
-            if (((visited[temp_y*20 + temp_x/8] >> (temp_x % 8)) & 1) != 1) { // for Aplite first check if pixel isn't already marked as set in user-defined array
-              if (temp_pixel != skip_color) set_pixel(bitmap_info, temp_y, temp_x, draw_color); // if pixel isn't of original color - set it
-              draw_color = 1 - draw_color; // revers pixel for "lined" effect
-              visited[temp_y*20 + temp_x/8] ^= (-1 ^ visited[temp_y*20 + temp_x/8]) & (1 << (temp_x % 8)); // in Aplite - set the bit
-            }
-          #endif
-        }
-        j+=decInc;
-      }
-      return;
-    }
-    longLen+=y;
-    for (int j=0x80+(x<<8);y>=longLen;--y) {
-      temp_y = y; temp_x = j >> 8;
-      if (temp_y >=bounds.origin.y && temp_y<bounds.size.h && temp_x >=bounds.origin.x && temp_x < bounds.size.w) {
-        temp_pixel = get_pixel(bitmap_info,  temp_y, temp_x);
-          #ifdef PBL_COLOR // for Basalt drawing pixel if it is not of original color or already drawn color
-            if (temp_pixel != skip_color && temp_pixel != draw_color) set_pixel(bitmap_info, temp_y, temp_x, draw_color);
-          #else
-            if (((visited[temp_y*20 + temp_x/8] >> (temp_x % 8)) & 1) != 1) { // for Aplite first check if pixel isn't already marked as set in user-defined array
-              if (temp_pixel != skip_color) set_pixel(bitmap_info, temp_y, temp_x, draw_color); // if pixel isn't of original color - set it
-              draw_color = 1 - draw_color; // revers pixel for "lined" effect
-              visited[temp_y*20 + temp_x/8] ^= (-1 ^ visited[temp_y*20 + temp_x/8]) & (1 << (temp_x % 8));
-            }
-          #endif
-      }
-      j-=decInc;
-    }
-    return; 
-  }
-
-  if (longLen>0) {
-    longLen+=x;
-    for (int j=0x80+(y<<8);x<=longLen;++x) {
-      temp_y = j >> 8; temp_x =  x;
-      if (temp_y >=bounds.origin.y && temp_y<bounds.size.h && temp_x >=bounds.origin.x && temp_x < bounds.size.w) {
-        temp_pixel = get_pixel(bitmap_info, temp_y, temp_x);
-          #ifdef PBL_COLOR // for Basalt drawing pixel if it is not of original color or already drawn color
-            if (temp_pixel != skip_color && temp_pixel != draw_color) set_pixel(bitmap_info, temp_y, temp_x, draw_color);
-          #else
-            if (((visited[temp_y*20 + temp_x/8] >> (temp_x % 8)) & 1) != 1) { // for Aplite first check if pixel isn't already marked as set in user-defined array
-              if (temp_pixel != skip_color) set_pixel(bitmap_info, temp_y, temp_x, draw_color); // if pixel isn't of original color - set it
-              draw_color = 1 - draw_color; // revers pixel for "lined" effect
-              visited[temp_y*20 + temp_x/8] ^= (-1 ^ visited[temp_y*20 + temp_x/8]) & (1 << (temp_x % 8));
-            }
-          #endif
-      }  
-      j+=decInc;
-    }
-    return;
-  }
-  longLen+=x;
-  for (int j=0x80+(y<<8);x>=longLen;--x) {
-    temp_y = j >> 8; temp_x =  x;
-    if (temp_y >=bounds.origin.y && temp_y<bounds.size.h && temp_x >=bounds.origin.x && temp_x < bounds.size.w) {
-      temp_pixel = get_pixel(bitmap_info, temp_y, temp_x);
-          #ifdef PBL_COLOR // for Basalt drawing pixel if it is not of original color or already drawn color
-            if (temp_pixel != skip_color && temp_pixel != draw_color) set_pixel(bitmap_info, temp_y, temp_x, draw_color);
-          #else
-            if (((visited[temp_y*20 + temp_x/8] >> (temp_x % 8)) & 1) != 1) { // for Aplite first check if pixel isn't already marked as set in user-defined array
-              if (temp_pixel != skip_color) set_pixel(bitmap_info, temp_y, temp_x, draw_color); // if pixel isn't of original color - set it
-              draw_color = 1 - draw_color; // revers pixel for "lined" effect
-              visited[temp_y*20 + temp_x/8] ^= (-1 ^ visited[temp_y*20 + temp_x/8]) & (1 << (temp_x % 8));
-            }
-          #endif
-    }  
-    j-=decInc;
-  }
-
-}
-
 //determine if array of colors contains specific color  
 bool gcolor_contains(GColor *color_array, GColor pixel_color)  {
   int i=0;
@@ -181,57 +98,316 @@ bool gcolor_contains(GColor *color_array, GColor pixel_color)  {
   return false;
 }
 
+#ifdef PBL_PLATFORM_APLITE
+// inverts pixels [x0, x1) of a 1-bit row (LSB is the leftmost pixel), going a word at a time in the middle
+static void invert_span_1bit(uint8_t *row, int x0, int x1) {
+  if (x0 >= x1) return;
+  
+  uint8_t *p = row + (x0 >> 3);
+  uint8_t *end = row + (x1 >> 3);
+  uint8_t head = 0xFF << (x0 & 7);
+  uint8_t tail = (1 << (x1 & 7)) - 1;
+  
+  if (p == end) { // span starts and ends within the same byte
+    *p ^= head & tail;
+    return;
+  }
+  
+  *p++ ^= head;
+  while (p < end && ((uintptr_t)p & 3)) *p++ ^= 0xFF;
+  for (; p + 4 <= end; p += 4) *(uint32_t*)p ^= 0xFFFFFFFF;
+  while (p < end) *p++ ^= 0xFF;
+  if (tail) *p ^= tail;
+}
+#endif
+
+// inverts pixels [x0, x1) of an 8-bit ARGB row 4 pixels at a time (keeping alpha opaque as the per-pixel version did)
+static void invert_span_8bit(uint8_t *row, int x0, int x1) {
+  uint8_t *p = row + x0;
+  uint8_t *end = row + x1;
+  
+  while (p < end && ((uintptr_t)p & 3)) { *p = (*p ^ 0x3F) | 0xC0; p++; }
+  for (; p + 4 <= end; p += 4) *(uint32_t*)p = (*(uint32_t*)p ^ 0x3F3F3F3F) | 0xC0C0C0C0;
+  while (p < end) { *p = (*p ^ 0x3F) | 0xC0; p++; }
+}
+
+// copies pixels [x0, x1) from src row to dst row (memmove on 8-bit rows), pixels missing in either row are skipped
+static void bitmap_row_copy_span(BitmapRow *dst, const BitmapRow *src, int x0, int x1) {
+  if (x0 < dst->min_x) x0 = dst->min_x;
+  if (x0 < src->min_x) x0 = src->min_x;
+  if (x1 > dst->max_x + 1) x1 = dst->max_x + 1;
+  if (x1 > src->max_x + 1) x1 = src->max_x + 1;
+  if (x0 >= x1) return;
+  
+  if (!dst->one_bit && !src->one_bit)
+    memmove(dst->data + x0, src->data + x0, x1 - x0);
+  else
+    for (int x = x0; x < x1; x++) bitmap_row_set(dst, x, bitmap_row_get(src, x));
+}
+
 //  ********* Graphics utility functions (probablu should be seaparated into anothe file?) ********* }
 
   
 
+// inverts given area of the bitmap
+// Works on whole row spans: a word at a time on 1-bit rows, 4 pixels at a time on 8-bit rows
+// and only inside min_x..max_x of each row on round displays.
+static void invert_apply(BitmapInfo *bitmap_info, GRect position) {
+  BitmapRow row;
+  
+  for (bitmap_row_begin(&row, bitmap_info, position.origin.y); row.y < position.origin.y + position.size.h; bitmap_row_next(&row)) {
+    // clipping span to the valid part of the row
+    int x0 = position.origin.x > row.min_x ? position.origin.x : row.min_x;
+    int x1 = position.origin.x + position.size.w <= row.max_x ? position.origin.x + position.size.w : row.max_x + 1;
+    
+    if (row.one_bit) {
+      #ifndef PBL_PLATFORM_APLITE // 1-bit palette is MSB first, not worth a fast path - flipping pixel by pixel
+        for (int x = x0; x < x1; x++) row.data[x / 8] ^= 128 >> (x % 8);
+      #else
+        invert_span_1bit(row.data, x0, x1);
+      #endif
+    } else {
+      invert_span_8bit(row.data, x0, x1);
+    }
+  }
+}
+
 // inverter effect.
 void effect_invert(GContext* ctx,  GRect position, void* param) {
   //capturing framebuffer bitmap
   GBitmap *fb = graphics_capture_frame_buffer(ctx);
   
   BitmapInfo bitmap_info;
-  bitmap_info.bitmap = fb;
-  bitmap_info.bitmap_data =  gbitmap_get_data(fb);
-  bitmap_info.bytes_per_row = gbitmap_get_bytes_per_row(fb);
-  bitmap_info.bitmap_format = gbitmap_get_format(fb);
-  
-  for (int y = 0; y < position.size.h; y++)
-     for (int x = 0; x < position.size.w; x++)
-        #ifdef PBL_COLOR // on Basalt simple doing NOT on entire returned byte/pixel
-          set_pixel(bitmap_info, y + position.origin.y, x + position.origin.x, (~get_pixel(bitmap_info, y + position.origin.y, x + position.origin.x))|11000000);
-        #else // on Aplite since only 1 and 0 is returning, doing "not" by 1 - pixel
-          set_pixel(bitmap_info, y + position.origin.y, x + position.origin.x, 1 - get_pixel(bitmap_info, y + position.origin.y, x + position.origin.x));
-        #endif
+  bitmap_info_init(&bitmap_info, fb);
+  
+  invert_apply(&bitmap_info, position);
  
   graphics_release_frame_buffer(ctx, fb);          
           
 }
 
-// colorize effect - given a target color, replace it with a new color
-// Added by Martin Norland (@cynorg)
-// Parameter:  GColor firstColor, GColor secondColor
-void effect_colorize(GContext* ctx,  GRect position, void* param) {
+// applies lut to pixels [x0, x1) of the row
+static void lut_apply_row(BitmapRow *row, int x0, int x1, const uint8_t *lut) {
+  if (x0 < row->min_x) x0 = row->min_x;
+  if (x1 > row->max_x + 1) x1 = row->max_x + 1;
+  
+  if (row->one_bit) { // 1 bit pixel is either 0 or 1, so only first two entries matter
+    if (lut[0] == 0 && lut[1] == 1) return;
+    #ifdef PBL_PLATFORM_APLITE
+      if (lut[0] == 1 && lut[1] == 0) {
+        invert_span_1bit(row->data, x0, x1);
+        return;
+      }
+    #endif
+    for (int x = x0; x < x1; x++) bitmap_row_set(row, x, lut[bitmap_row_get(row, x) ? 1 : 0]);
+    return;
+  }
+  
+  uint8_t *p = row->data + x0;
+  uint8_t *end = row->data + x1;
+  for (; p + 4 <= end; p += 4) {
+    p[0] = lut[p[0]]; p[1] = lut[p[1]]; p[2] = lut[p[2]]; p[3] = lut[p[3]];
+  }
+  while (p < end) { *p = lut[*p]; p++; }
+}
+
+// applies lut to given area of the bitmap
+static void lut_apply(BitmapInfo *bitmap_info, GRect position, const uint8_t *lut) {
+  BitmapRow row;
+  for (bitmap_row_begin(&row, bitmap_info, position.origin.y); row.y < position.origin.y + position.size.h; bitmap_row_next(&row))
+    lut_apply_row(&row, position.origin.x, position.origin.x + position.size.w, lut);
+}
+
+// fills lut with mapping that leaves every color as is
+static void lut_identity(uint8_t *lut) {
+  for (int i = 0; i < 256; i++) lut[i] = i;
+}
+
+// lut of the inverter
+static void lut_build_invert(uint8_t *lut, void *param) {
+  #ifdef PBL_COLOR
+    for (int i = 0; i < 256; i++) lut[i] = (i ^ 0x3F) | 0xC0;
+  #else
+    lut_identity(lut);
+    lut[0] = 1;
+    lut[1] = 0;
+  #endif
+}
+
+// lut of colorize - given a target color, replace it with a new color
+static void lut_build_colorize(uint8_t *lut, void *param) {
+  lut_identity(lut);
 #ifdef PBL_COLOR // only logical to do anything on Basalt - otherwise you're just ... drawing a black|white GRect
+  EffectColorpair *paint = (EffectColorpair *)param;
+  for (int i = 0; i < 256; i++)
+    if (gcolor_equal((GColor){.argb = i}, paint->firstColor)) lut[i] = paint->secondColor.argb;
+#endif
+}
+
+// lut of colorswap - swaps two colors
+static void lut_build_colorswap(uint8_t *lut, void *param) {
+  lut_identity(lut);
+#ifdef PBL_COLOR // only logical to do anything on Basalt - otherwise you're just ... doing an invert
+  EffectColorpair *swap = (EffectColorpair *)param;
+  for (int i = 0; i < 256; i++) {
+    if (gcolor_equal((GColor){.argb = i}, swap->firstColor))
+      lut[i] = swap->secondColor.argb;
+    else if (gcolor_equal((GColor){.argb = i}, swap->secondColor))
+      lut[i] = swap->firstColor.argb;
+  }
+#endif
+}
+
+// lut of black and white only inverter
+static void lut_build_invert_bw_only(uint8_t *lut, void *param) {
+  lut_identity(lut);
+  #ifdef PBL_COLOR // on Basalt invert only black or white
+    lut[GColorBlackARGB8] = GColorWhiteARGB8;
+    lut[GColorWhiteARGB8] = GColorBlackARGB8;
+  #else // on Aplite since only 1 and 0 is returning, doing "not" by 1 - pixel
+    lut[0] = 1;
+    lut[1] = 0;
+  #endif
+}
+
+#ifdef PBL_COLOR
+// Color spread is not even, so need to handcraft the opposing brightness of colors,
+// which is probably subjective and open for improvement
+static const uint8_t brightness_pairs[][2] = {
+  { GColorOxfordBlueARGB8, GColorCelesteARGB8 },
+  { GColorDukeBlueARGB8, GColorVividCeruleanARGB8 },
+  { GColorBlueARGB8, GColorPictonBlueARGB8 },
+  { GColorDarkGreenARGB8, GColorMintGreenARGB8 },
+  { GColorMidnightGreenARGB8, GColorMediumSpringGreenARGB8 },
+  { GColorCobaltBlueARGB8, GColorCyanARGB8 },
+  { GColorBlueMoonARGB8, GColorElectricBlueARGB8 },
+  { GColorIslamicGreenARGB8, GColorMalachiteARGB8 },
+  { GColorJaegerGreenARGB8, GColorScreaminGreenARGB8 },
+  { GColorTiffanyBlueARGB8, GColorCadetBlueARGB8 },
+  { GColorVividCeruleanARGB8, GColorDukeBlueARGB8 },
+  { GColorGreenARGB8, GColorMayGreenARGB8 },
+  { GColorMalachiteARGB8, GColorIslamicGreenARGB8 },
+  { GColorMediumSpringGreenARGB8, GColorMidnightGreenARGB8 },
+  { GColorCyanARGB8, GColorCobaltBlueARGB8 },
+  { GColorBulgarianRoseARGB8, GColorMelonARGB8 },
+  { GColorImperialPurpleARGB8, GColorRichBrilliantLavenderARGB8 },
+  { GColorIndigoARGB8, GColorLavenderIndigoARGB8 },
+  { GColorElectricUltramarineARGB8, GColorVeryLightBlueARGB8 },
+  { GColorArmyGreenARGB8, GColorBrassARGB8 },
+  { GColorDarkGrayARGB8, GColorLightGrayARGB8 },
+  { GColorLibertyARGB8, GColorBabyBlueEyesARGB8 },
+  { GColorVeryLightBlueARGB8, GColorElectricUltramarineARGB8 },
+  { GColorKellyGreenARGB8, GColorGreenARGB8 },
+  { GColorMayGreenARGB8, GColorMediumAquamarineARGB8 },
+  { GColorCadetBlueARGB8, GColorTiffanyBlueARGB8 },
+  { GColorPictonBlueARGB8, GColorBlueARGB8 },
+  { GColorBrightGreenARGB8, GColorIslamicGreenARGB8 },
+  { GColorScreaminGreenARGB8, GColorKellyGreenARGB8 },
+  { GColorMediumAquamarineARGB8, GColorMayGreenARGB8 },
+  { GColorElectricBlueARGB8, GColorBlueMoonARGB8 },
+  { GColorDarkCandyAppleRedARGB8, GColorMelonARGB8 },
+  { GColorJazzberryJamARGB8, GColorBrilliantRoseARGB8 },
+  { GColorPurpleARGB8, GColorShockingPinkARGB8 },
+  { GColorVividVioletARGB8, GColorPurpureusARGB8 },
+  { GColorWindsorTanARGB8, GColorRoseValeARGB8 },
+  { GColorRoseValeARGB8, GColorWindsorTanARGB8 },
+  { GColorPurpureusARGB8, GColorVividVioletARGB8 },
+  { GColorLavenderIndigoARGB8, GColorIndigoARGB8 },
+  { GColorLimerickARGB8, GColorPastelYellowARGB8 },
+  { GColorBrassARGB8, GColorArmyGreenARGB8 },
+  { GColorLightGrayARGB8, GColorDarkGrayARGB8 },
+  { GColorBabyBlueEyesARGB8, GColorLibertyARGB8 },
+  { GColorSpringBudARGB8, GColorDarkGreenARGB8 },
+  { GColorInchwormARGB8, GColorMidnightGreenARGB8 },
+  { GColorMintGreenARGB8, GColorDarkGreenARGB8 },
+  { GColorCelesteARGB8, GColorOxfordBlueARGB8 },
+  { GColorRedARGB8, GColorSunsetOrangeARGB8 },
+  { GColorFollyARGB8, GColorMelonARGB8 },
+  { GColorFashionMagentaARGB8, GColorMagentaARGB8 },
+  { GColorMagentaARGB8, GColorFashionMagentaARGB8 },
+  { GColorOrangeARGB8, GColorRajahARGB8 },
+  { GColorSunsetOrangeARGB8, GColorRedARGB8 },
+  { GColorBrilliantRoseARGB8, GColorJazzberryJamARGB8 },
+  { GColorShockingPinkARGB8, GColorPurpleARGB8 },
+  { GColorChromeYellowARGB8, GColorWindsorTanARGB8 },
+  { GColorRajahARGB8, GColorOrangeARGB8 },
+  { GColorMelonARGB8, GColorDarkCandyAppleRedARGB8 },
+  { GColorRichBrilliantLavenderARGB8, GColorImperialPurpleARGB8 },
+  { GColorYellowARGB8, GColorChromeYellowARGB8 },
+  { GColorIcterineARGB8, GColorChromeYellowARGB8 },
+  { GColorPastelYellowARGB8, GColorChromeYellowARGB8 },
+};
+#endif
+
+// lut of brightness inverter, colors not listed (including black and white) stay as they are
+static void lut_build_invert_brightness(uint8_t *lut, void *param) {
+  lut_identity(lut);
+#ifdef PBL_COLOR
+  for (unsigned int i = 0; i < ARRAY_LENGTH(brightness_pairs); i++) lut[brightness_pairs[i][0]] = brightness_pairs[i][1];
+#endif
+}
+
+// builds lut of a per-pixel effect, returns false if effect can't be expressed as one
+bool effect_get_lut(effect_cb *effect, void *param, uint8_t *lut) {
+  if (effect == effect_lut) {
+    memcpy(lut, param, 256);
+  } else if (effect == effect_invert) {
+    lut_build_invert(lut, param);
+  } else if (effect == effect_colorize) {
+    lut_build_colorize(lut, param);
+  } else if (effect == effect_colorswap) {
+    lut_build_colorswap(lut, param);
+  } else if (effect == effect_invert_bw_only) {
+    lut_build_invert_bw_only(lut, param);
+  } else if (effect == effect_invert_brightness) {
+    lut_build_invert_brightness(lut, param);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// applies lut to given area of captured bitmap, skipping identity and taking the span path for plain inversion
+void effect_lut_apply(BitmapInfo *bitmap_info, GRect position, const uint8_t *lut) {
+  bool identity = true, invert = true;
+  for (int i = 0; i < 256 && (identity || invert); i++) {
+    identity = identity && lut[i] == i;
+    #ifdef PBL_COLOR
+      invert = invert && lut[i] == ((i ^ 0x3F) | 0xC0);
+    #endif
+  }
+  #ifndef PBL_COLOR // 1-bit inversion is already handled by lut_apply_row
+    invert = false;
+  #endif
+  
+  if (identity) return;
+  if (invert)
+    invert_apply(bitmap_info, position);
+  else
+    lut_apply(bitmap_info, position, lut);
+}
+
+// LUT effect - maps every pixel thru a 256 entry table in a single pass
+void effect_lut(GContext* ctx,  GRect position, void* param) {
   //capturing framebuffer bitmap
   GBitmap *fb = graphics_capture_frame_buffer(ctx);
   
   BitmapInfo bitmap_info;
-  bitmap_info.bitmap = fb;
-  bitmap_info.bitmap_data =  gbitmap_get_data(fb);
-  bitmap_info.bytes_per_row = gbitmap_get_bytes_per_row(fb);
-  bitmap_info.bitmap_format = gbitmap_get_format(fb);
+  bitmap_info_init(&bitmap_info, fb);
+  
+  effect_lut_apply(&bitmap_info, position, (const uint8_t *)param);
   
-  EffectColorpair *paint = (EffectColorpair *)param;
-
-  for (int y = 0; y < position.size.h; y++){
-     for (int x = 0; x < position.size.w; x++){
-        if (gcolor_equal((GColor)get_pixel(bitmap_info, y + position.origin.y, x + position.origin.x), paint->firstColor)){
-           set_pixel(bitmap_info, y + position.origin.y, x + position.origin.x, (uint8_t)paint->secondColor.argb);
-        }
-     }
   graphics_release_frame_buffer(ctx, fb);
-  }
+}
+
+// colorize effect - given a target color, replace it with a new color
+// Added by Martin Norland (@cynorg)
+// Parameter:  GColor firstColor, GColor secondColor
+void effect_colorize(GContext* ctx,  GRect position, void* param) {
+#ifdef PBL_COLOR // only logical to do anything on Basalt - otherwise you're just ... drawing a black|white GRect
+  uint8_t lut[256];
+  lut_build_colorize(lut, param);
+  effect_lut(ctx, position, lut);
 #endif
 }
 
@@ -241,242 +417,123 @@ void effect_colorize(GContext* ctx,  GRect position, void* param) {
 // Parameter:  GColor firstColor, GColor secondColor
 void effect_colorswap(GContext* ctx,  GRect position, void* param) {
 #ifdef PBL_COLOR // only logical to do anything on Basalt - otherwise you're just ... doing an invert
-  //capturing framebuffer bitmap
-  GBitmap *fb = graphics_capture_frame_buffer(ctx);
- 
-  BitmapInfo bitmap_info;
-  bitmap_info.bitmap = fb;
-  bitmap_info.bitmap_data =  gbitmap_get_data(fb);
-  bitmap_info.bytes_per_row = gbitmap_get_bytes_per_row(fb);
-  bitmap_info.bitmap_format = gbitmap_get_format(fb);
-  
-  EffectColorpair *swap = (EffectColorpair *)param;
-  GColor pixel;
-
-  for (int y = 0; y < position.size.h; y++){
-     for (int x = 0; x < position.size.w; x++){
-          pixel.argb = get_pixel(bitmap_info, y + position.origin.y, x + position.origin.x);
-          if (gcolor_equal(pixel, swap->firstColor))
-            set_pixel(bitmap_info, y + position.origin.y, x + position.origin.x, swap->secondColor.argb);
-          else if (gcolor_equal(pixel, swap->secondColor))
-            set_pixel(bitmap_info, y + position.origin.y, x + position.origin.x, swap->firstColor.argb);
-     }
-  graphics_release_frame_buffer(ctx, fb);
-  }
+  uint8_t lut[256];
+  lut_build_colorswap(lut, param);
+  effect_lut(ctx, position, lut);
 #endif
 }
 
 // invert black and white only (leaves all other colors intact).
 void effect_invert_bw_only(GContext* ctx,  GRect position, void* param) {
-  //capturing framebuffer bitmap
-  GBitmap *fb = graphics_capture_frame_buffer(ctx);
-  
-  BitmapInfo bitmap_info;
-  bitmap_info.bitmap = fb;
-  bitmap_info.bitmap_data =  gbitmap_get_data(fb);
-  bitmap_info.bytes_per_row = gbitmap_get_bytes_per_row(fb);
-  bitmap_info.bitmap_format = gbitmap_get_format(fb);
+  uint8_t lut[256];
+  lut_build_invert_bw_only(lut, param);
+  effect_lut(ctx, position, lut);
+}
 
+// invert brightness of colors (leaves hue more or less intact and does not apply to black and white).
+void effect_invert_brightness(GContext* ctx,  GRect position, void* param) {
 #ifdef PBL_COLOR
-  GColor pixel;
-#endif
+  static uint8_t lut[256];
+  static bool lut_ready = false;
   
-  for (int y = 0; y < position.size.h; y++) {
-     for (int x = 0; x < position.size.w; x++) {
-        #ifdef PBL_COLOR // on Basalt invert only black or white
-          pixel.argb = get_pixel(bitmap_info, y + position.origin.y, x + position.origin.x);
-          if (gcolor_equal(pixel, GColorBlack))
-            set_pixel(bitmap_info, y + position.origin.y, x + position.origin.x, GColorWhite.argb);
-          else if (gcolor_equal(pixel, GColorWhite))
-            set_pixel(bitmap_info, y + position.origin.y, x + position.origin.x, GColorBlack.argb);
-        #else // on Aplite since only 1 and 0 is returning, doing "not" by 1 - pixel
-          set_pixel(bitmap_info, y + position.origin.y, x + position.origin.x, 1 - get_pixel(bitmap_info, y + position.origin.y, x + position.origin.x));
-        #endif
-     }
+  if (!lut_ready) { // building table on first use
+    lut_build_invert_brightness(lut, param);
+    lut_ready = true;
   }
- 
-  graphics_release_frame_buffer(ctx, fb);          
-          
+  
+  effect_lut(ctx, position, lut);
+#endif
 }
 
-// invert brightness of colors (leaves hue more or less intact and does not apply to black and white).
-void effect_invert_brightness(GContext* ctx,  GRect position, void* param) {
-#ifdef PBL_COLOR
-  //capturing framebuffer bitmap
-  GBitmap *fb = graphics_capture_frame_buffer(ctx);
- 
-  BitmapInfo bitmap_info;
-  bitmap_info.bitmap = fb;
-  bitmap_info.bitmap_data =  gbitmap_get_data(fb);
-  bitmap_info.bytes_per_row = gbitmap_get_bytes_per_row(fb);
-  bitmap_info.bitmap_format = gbitmap_get_format(fb);
+// bit reversed nibbles, for mirroring 1-bit rows a byte at a time
+static const uint8_t reverse_nibble[16] = {0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE, 0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF};
+
+#define REVERSE_BYTE(b) ((reverse_nibble[(b) & 15] << 4) | reverse_nibble[(b) >> 4])
 
-  GColor pixel;
-  GColor pixel_new;
+// swaps pixels [x0, x1) of two rows (whole bytes at a time), pixels missing in either row are skipped
+static void bitmap_row_swap_span(BitmapRow *a, BitmapRow *b, int x0, int x1) {
+  if (x0 < a->min_x) x0 = a->min_x;
+  if (x0 < b->min_x) x0 = b->min_x;
+  if (x1 > a->max_x + 1) x1 = a->max_x + 1;
+  if (x1 > b->max_x + 1) x1 = b->max_x + 1;
   
-  for (int y = 0; y < position.size.h; y++) {
-     for (int x = 0; x < position.size.w; x++) {
-         pixel.argb = get_pixel(bitmap_info, y + position.origin.y, x + position.origin.x);
-         
-         if (!gcolor_equal(pixel, GColorBlack) && !gcolor_equal(pixel, GColorWhite)) {
-           // Only apply if not black/white (add effect_invert_bw_only for that too)
-           
-           // Color spread is not even, so need to handcraft the opposing brightness of colors,
-           // which is probably subjective and open for improvement
-           if (gcolor_equal(pixel, GColorOxfordBlue))
-             pixel_new = GColorCeleste;
-           else if (gcolor_equal(pixel, GColorDukeBlue))
-             pixel_new = GColorVividCerulean;
-           else if (gcolor_equal(pixel, GColorBlue))
-             pixel_new = GColorPictonBlue;
-           else if (gcolor_equal(pixel, GColorDarkGreen))
-             pixel_new = GColorMintGreen;
-           else if (gcolor_equal(pixel, GColorMidnightGreen))
-             pixel_new = GColorMediumSpringGreen;
-           else if (gcolor_equal(pixel, GColorCobaltBlue))
-             pixel_new = GColorCyan;
-           else if (gcolor_equal(pixel, GColorBlueMoon))
-             pixel_new = GColorElectricBlue;
-           else if (gcolor_equal(pixel, GColorIslamicGreen))
-             pixel_new = GColorMalachite;
-           else if (gcolor_equal(pixel, GColorJaegerGreen))
-             pixel_new = GColorScreaminGreen;
-           else if (gcolor_equal(pixel, GColorTiffanyBlue))
-             pixel_new = GColorCadetBlue;
-           else if (gcolor_equal(pixel, GColorVividCerulean))
-             pixel_new = GColorDukeBlue;
-           else if (gcolor_equal(pixel, GColorGreen))
-             pixel_new = GColorMayGreen;
-           else if (gcolor_equal(pixel, GColorMalachite))
-             pixel_new = GColorIslamicGreen;
-           else if (gcolor_equal(pixel, GColorMediumSpringGreen))
-             pixel_new = GColorMidnightGreen;
-           else if (gcolor_equal(pixel, GColorCyan))
-             pixel_new = GColorCobaltBlue;
-           else if (gcolor_equal(pixel, GColorBulgarianRose))
-             pixel_new = GColorMelon;
-           else if (gcolor_equal(pixel, GColorImperialPurple))
-             pixel_new = GColorRichBrilliantLavender;
-           else if (gcolor_equal(pixel, GColorIndigo))
-             pixel_new = GColorLavenderIndigo;
-           else if (gcolor_equal(pixel, GColorElectricUltramarine))
-             pixel_new = GColorVeryLightBlue;
-           else if (gcolor_equal(pixel, GColorArmyGreen))
-             pixel_new = GColorBrass;
-           else if (gcolor_equal(pixel, GColorDarkGray))
-             pixel_new = GColorLightGray;
-           else if (gcolor_equal(pixel, GColorLiberty))
-             pixel_new = GColorBabyBlueEyes;
-           else if (gcolor_equal(pixel, GColorVeryLightBlue))
-             pixel_new = GColorElectricUltramarine;
-           else if (gcolor_equal(pixel, GColorKellyGreen))
-             pixel_new = GColorGreen;
-           else if (gcolor_equal(pixel, GColorMayGreen))
-             pixel_new = GColorMediumAquamarine;
-           else if (gcolor_equal(pixel, GColorCadetBlue))
-             pixel_new = GColorTiffanyBlue;
-           else if (gcolor_equal(pixel, GColorPictonBlue))
-             pixel_new = GColorBlue;
-           else if (gcolor_equal(pixel, GColorBrightGreen))
-             pixel_new = GColorIslamicGreen;
-           else if (gcolor_equal(pixel, GColorScreaminGreen))
-             pixel_new = GColorKellyGreen;
-           else if (gcolor_equal(pixel, GColorMediumAquamarine))
-             pixel_new = GColorMayGreen;
-           else if (gcolor_equal(pixel, GColorElectricBlue))
-             pixel_new = GColorBlueMoon;
-           else if (gcolor_equal(pixel, GColorDarkCandyAppleRed))
-             pixel_new = GColorMelon;
-           else if (gcolor_equal(pixel, GColorJazzberryJam))
-             pixel_new = GColorBrilliantRose;
-           else if (gcolor_equal(pixel, GColorPurple))
-             pixel_new = GColorShockingPink;
-           else if (gcolor_equal(pixel, GColorVividViolet))
-             pixel_new = GColorPurpureus;
-           else if (gcolor_equal(pixel, GColorWindsorTan))
-             pixel_new = GColorRoseVale;
-           else if (gcolor_equal(pixel, GColorRoseVale))
-             pixel_new = GColorWindsorTan;
-           else if (gcolor_equal(pixel, GColorPurpureus))
-             pixel_new = GColorVividViolet;
-           else if (gcolor_equal(pixel, GColorLavenderIndigo))
-             pixel_new = GColorIndigo;
-           else if (gcolor_equal(pixel, GColorLimerick))
-             pixel_new = GColorPastelYellow;
-           else if (gcolor_equal(pixel, GColorBrass))
-             pixel_new = GColorArmyGreen;
-           else if (gcolor_equal(pixel, GColorLightGray))
-             pixel_new = GColorDarkGray;
-           else if (gcolor_equal(pixel, GColorBabyBlueEyes))
-             pixel_new = GColorLiberty;
-           else if (gcolor_equal(pixel, GColorSpringBud))
-             pixel_new = GColorDarkGreen;
-           else if (gcolor_equal(pixel, GColorInchworm))
-             pixel_new = GColorMidnightGreen;
-           else if (gcolor_equal(pixel, GColorMintGreen))
-             pixel_new = GColorDarkGreen;
-           else if (gcolor_equal(pixel, GColorCeleste))
-             pixel_new = GColorOxfordBlue;
-           else if (gcolor_equal(pixel, GColorRed))
-             pixel_new = GColorSunsetOrange;
-           else if (gcolor_equal(pixel, GColorFolly))
-             pixel_new = GColorMelon;
-           else if (gcolor_equal(pixel, GColorFashionMagenta))
-             pixel_new = GColorMagenta ;
-           else if (gcolor_equal(pixel, GColorMagenta))
-             pixel_new = GColorFashionMagenta;
-           else if (gcolor_equal(pixel, GColorOrange))
-             pixel_new = GColorRajah;
-           else if (gcolor_equal(pixel, GColorSunsetOrange))
-             pixel_new = GColorRed;
-           else if (gcolor_equal(pixel, GColorBrilliantRose))
-             pixel_new = GColorJazzberryJam;
-           else if (gcolor_equal(pixel, GColorShockingPink))
-             pixel_new = GColorPurple;
-           else if (gcolor_equal(pixel, GColorChromeYellow))
-             pixel_new = GColorWindsorTan;
-           else if (gcolor_equal(pixel, GColorRajah))
-             pixel_new = GColorOrange;
-           else if (gcolor_equal(pixel, GColorMelon))
-             pixel_new = GColorDarkCandyAppleRed;
-           else if (gcolor_equal(pixel, GColorRichBrilliantLavender))
-             pixel_new = GColorImperialPurple;
-           else if (gcolor_equal(pixel, GColorYellow))
-             pixel_new = GColorChromeYellow;
-           else if (gcolor_equal(pixel, GColorIcterine))
-             pixel_new = GColorChromeYellow;
-           else if (gcolor_equal(pixel, GColorPastelYellow))
-             pixel_new = GColorChromeYellow;
-           
-           set_pixel(bitmap_info, y + position.origin.y, x + position.origin.x, pixel_new.argb);
-         }
-     }
+  uint8_t temp;
+  for (int x = x0; x < x1;) {
+    if (a->one_bit && (x % 8 || x + 8 > x1)) { // partial byte of 1-bit row
+      temp = bitmap_row_get(a, x);
+      bitmap_row_set(a, x, bitmap_row_get(b, x));
+      bitmap_row_set(b, x, temp);
+      x++;
+    } else {
+      uint8_t *pa = a->data + (a->one_bit ? x / 8 : x), *pb = b->data + (a->one_bit ? x / 8 : x);
+      temp = *pa; *pa = *pb; *pb = temp;
+      x += a->one_bit ? 8 : 1;
+    }
+  }
+}
+
+// reverses pixels [x0, x1) of a row in place (clipped to the row), byte aligned 1-bit spans go a byte at a time
+static void bitmap_row_reverse_span(BitmapRow *row, int x0, int x1) {
+  if (x0 < row->min_x) x0 = row->min_x;
+  if (x1 > row->max_x + 1) x1 = row->max_x + 1;
+  if (x0 >= x1) return;
+  
+  uint8_t temp;
+  if (!row->one_bit) {
+    for (uint8_t *l = row->data + x0, *r = row->data + x1 - 1; l < r; l++, r--) {
+      temp = *l; *l = *r; *r = temp;
+    }
+  } else if (x0 % 8 == 0 && x1 % 8 == 0) {
+    uint8_t *l = row->data + x0 / 8, *r = row->data + x1 / 8 - 1;
+    for (; l < r; l++, r--) {
+      temp = REVERSE_BYTE(*l); *l = REVERSE_BYTE(*r); *r = temp;
+    }
+    if (l == r) *l = REVERSE_BYTE(*l);
+  } else {
+    for (int l = x0, r = x1 - 1; l < r; l++, r--) {
+      temp = bitmap_row_get(row, l);
+      bitmap_row_set(row, l, bitmap_row_get(row, r));
+      bitmap_row_set(row, r, temp);
+    }
+  }
+}
+
+// clips rect to bitmap bounds
+static GRect bitmap_clip_rect(BitmapInfo *bitmap_info, GRect rect) {
+  GRect bounds = bitmap_info->bounds;
+  int x0 = rect.origin.x > bounds.origin.x ? rect.origin.x : bounds.origin.x;
+  int y0 = rect.origin.y > bounds.origin.y ? rect.origin.y : bounds.origin.y;
+  int x1 = rect.origin.x + rect.size.w < bounds.origin.x + bounds.size.w ? rect.origin.x + rect.size.w : bounds.origin.x + bounds.size.w;
+  int y1 = rect.origin.y + rect.size.h < bounds.origin.y + bounds.size.h ? rect.origin.y + rect.size.h : bounds.origin.y + bounds.size.h;
+  return GRect(x0, y0, x1 > x0 ? x1 - x0 : 0, y1 > y0 ? y1 - y0 : 0);
+}
+
+// flips rect upside down swapping whole rows
+static void mirror_vertical(BitmapInfo *bitmap_info, GRect rect) {
+  BitmapRow top, bottom;
+  for (int y = 0; y < rect.size.h / 2; y++) {
+    bitmap_row_begin(&top, bitmap_info, rect.origin.y + y);
+    bitmap_row_begin(&bottom, bitmap_info, rect.origin.y + rect.size.h - 1 - y);
+    bitmap_row_swap_span(&top, &bottom, rect.origin.x, rect.origin.x + rect.size.w);
   }
- 
-  graphics_release_frame_buffer(ctx, fb);          
-          
-#endif
+}
+
+// flips rect left to right reversing every row
+static void mirror_horizontal(BitmapInfo *bitmap_info, GRect rect) {
+  BitmapRow row;
+  for (bitmap_row_begin(&row, bitmap_info, rect.origin.y); row.y < rect.origin.y + rect.size.h; bitmap_row_next(&row))
+    bitmap_row_reverse_span(&row, rect.origin.x, rect.origin.x + rect.size.w);
 }
 
 // vertical mirror effect.
 void effect_mirror_vertical(GContext* ctx, GRect position, void* param) {
-  uint8_t temp_pixel;  
-  
   //capturing framebuffer bitmap
   GBitmap *fb = graphics_capture_frame_buffer(ctx);
   
   BitmapInfo bitmap_info;
-  bitmap_info.bitmap = fb;
-  bitmap_info.bitmap_data =  gbitmap_get_data(fb);
-  bitmap_info.bytes_per_row = gbitmap_get_bytes_per_row(fb);
-  bitmap_info.bitmap_format = gbitmap_get_format(fb);
-
-  for (int y = 0; y < position.size.h / 2 ; y++)
-     for (int x = 0; x < position.size.w; x++){
-        temp_pixel = get_pixel(bitmap_info, y + position.origin.y, x + position.origin.x);
-        set_pixel(bitmap_info, y + position.origin.y, x + position.origin.x, get_pixel(bitmap_info, position.origin.y + position.size.h - y - 2, x + position.origin.x));
-        set_pixel(bitmap_info, position.origin.y + position.size.h - y - 2, x + position.origin.x, temp_pixel);
-     }
+  bitmap_info_init(&bitmap_info, fb);
+
+  mirror_vertical(&bitmap_info, bitmap_clip_rect(&bitmap_info, position));
   
   graphics_release_frame_buffer(ctx, fb);
 }
@@ -484,120 +541,324 @@ void effect_mirror_vertical(GContext* ctx, GRect position, void* param) {
 
 // horizontal mirror effect.
 void effect_mirror_horizontal(GContext* ctx, GRect position, void* param) {
-  uint8_t temp_pixel;  
-  
   //capturing framebuffer bitmap
   GBitmap *fb = graphics_capture_frame_buffer(ctx);
   
   BitmapInfo bitmap_info;
-  bitmap_info.bitmap = fb;
-  bitmap_info.bitmap_data =  gbitmap_get_data(fb);
-  bitmap_info.bytes_per_row = gbitmap_get_bytes_per_row(fb);
-  bitmap_info.bitmap_format = gbitmap_get_format(fb);
-
-  for (int y = 0; y < position.size.h; y++)
-     for (int x = 0; x < position.size.w / 2; x++){
-        temp_pixel = get_pixel(bitmap_info, y + position.origin.y, x + position.origin.x);
-        set_pixel(bitmap_info, y + position.origin.y, x + position.origin.x, get_pixel(bitmap_info, y + position.origin.y, position.origin.x + position.size.w - x - 2));
-        set_pixel(bitmap_info, y + position.origin.y, position.origin.x + position.size.w - x - 2, temp_pixel);
-     }
+  bitmap_info_init(&bitmap_info, fb);
+
+  mirror_horizontal(&bitmap_info, bitmap_clip_rect(&bitmap_info, position));
   
   graphics_release_frame_buffer(ctx, fb);
 }
 
+#define ROTATE_TILE 8 // transpose tile size - a byte of 1-bit pixels and a couple of cache lines of 8-bit ones
+
+// transposes n x n square at (x0, y0) in place, tile by tile so both tiles of each swapped pair stay in cache;
+// only the cursors of the rows of the two tiles are live
+static void transpose_square(BitmapInfo *bitmap_info, int x0, int y0, int n) {
+  BitmapRow tile_rows[ROTATE_TILE], pair_rows[ROTATE_TILE];
+  uint8_t temp;
+  for (int ty = 0; ty < n; ty += ROTATE_TILE) {
+    for (int y = ty; y < ty + ROTATE_TILE && y < n; y++) bitmap_row_begin(&tile_rows[y - ty], bitmap_info, y0 + y);
+    for (int tx = ty; tx < n; tx += ROTATE_TILE) {
+      BitmapRow *rows_x = tile_rows;
+      if (tx != ty) {
+        for (int x = tx; x < tx + ROTATE_TILE && x < n; x++) bitmap_row_begin(&pair_rows[x - tx], bitmap_info, y0 + x);
+        rows_x = pair_rows;
+      }
+      for (int y = ty; y < ty + ROTATE_TILE && y < n; y++)
+        for (int x = (tx == ty ? y + 1 : tx); x < tx + ROTATE_TILE && x < n; x++) {
+          temp = bitmap_row_get(&tile_rows[y - ty], x0 + x);
+          bitmap_row_set(&tile_rows[y - ty], x0 + x, bitmap_row_get(&rows_x[x - tx], x0 + y));
+          bitmap_row_set(&rows_x[x - tx], x0 + y, temp);
+        }
+    }
+  }
+}
+
 // Rotate 90 degrees
 // Added by Ron64
-// Parameter:  true: rotate right/clockwise,  false: rotate left/counter_clockwise
+// Parameter:  true: rotate right/clockwise,  false: rotate left/counter_clockwise, 2: rotate 180 degrees
+// 90 degree rotations turn the centred square of the layer as a tiled transpose followed by a mirror,
+// 180 degrees is a mirror on both axes and covers the whole layer.
 void effect_rotate_90_degrees(GContext* ctx,  GRect position, void* param){
+  int32_t mode = (int32_t)(intptr_t)param;
 
   //capturing framebuffer bitmap
   GBitmap *fb = graphics_capture_frame_buffer(ctx);
   
   BitmapInfo bitmap_info;
-  bitmap_info.bitmap = fb;
-  bitmap_info.bitmap_data =  gbitmap_get_data(fb);
-  bitmap_info.bytes_per_row = gbitmap_get_bytes_per_row(fb);
-  bitmap_info.bitmap_format = gbitmap_get_format(fb);
+  bitmap_info_init(&bitmap_info, fb);
   
-  bool right = (bool)param;
-  uint8_t qtr, xCn, yCn, temp_pixel;
-  xCn= position.origin.x + position.size.w /2;
-  yCn= position.origin.y + position.size.h /2;
-  qtr=position.size.w;
-  if (position.size.h < qtr)
-    qtr= position.size.h;
-  qtr= qtr/2;
-
-  for (int c1 = 0; c1 < qtr; c1++)
-    for (int c2 = 1; c2 < qtr; c2++){
-      temp_pixel = get_pixel(bitmap_info, yCn +c1, xCn +c2);
-      if (right){
-        set_pixel(bitmap_info, yCn +c1, xCn +c2, get_pixel(bitmap_info, yCn -c2, xCn +c1));
-        set_pixel(bitmap_info, yCn -c2, xCn +c1, get_pixel(bitmap_info, yCn -c1, xCn -c2));
-        set_pixel(bitmap_info, yCn -c1, xCn -c2, get_pixel(bitmap_info, yCn +c2, xCn -c1));
-        set_pixel(bitmap_info, yCn +c2, xCn -c1, temp_pixel);
-      }
-      else{
-        set_pixel(bitmap_info, yCn +c1, xCn +c2, get_pixel(bitmap_info, yCn +c2, xCn -c1));
-        set_pixel(bitmap_info, yCn +c2, xCn -c1, get_pixel(bitmap_info, yCn -c1, xCn -c2));
-        set_pixel(bitmap_info, yCn -c1, xCn -c2, get_pixel(bitmap_info, yCn -c2, xCn +c1));
-        set_pixel(bitmap_info, yCn -c2, xCn +c1, temp_pixel);
-      }
-     }
+  if (mode == 2) {
+    GRect rect = bitmap_clip_rect(&bitmap_info, position);
+    mirror_vertical(&bitmap_info, rect);
+    mirror_horizontal(&bitmap_info, rect);
+    graphics_release_frame_buffer(ctx, fb);
+    return;
+  }
+  
+  int n = position.size.w < position.size.h ? position.size.w : position.size.h;
+  GRect square = GRect(position.origin.x + (position.size.w - n) / 2, position.origin.y + (position.size.h - n) / 2, n, n);
+  if (n > 0) {
+    transpose_square(&bitmap_info, square.origin.x, square.origin.y, n);
+    
+    if (mode) mirror_horizontal(&bitmap_info, bitmap_clip_rect(&bitmap_info, square));
+    else mirror_vertical(&bitmap_info, bitmap_clip_rect(&bitmap_info, square));
+  }
   
   graphics_release_frame_buffer(ctx, fb);
 }
 
+// blur line modes
+#define BLUR_COLOR  0 // ARGB2222 pixels, each color channel averaged
+#define BLUR_DITHER 1 // 1-bit pixels, window average ordered-dithered
+
+// spreads ARGB2222 color channels into 11-bit fields so a single add sums all three of them
+// (red only has the top 10 bits, window sum 3*(2*radius+1) fits up to BLUR_MAX_RADIUS)
+#define BLUR_SPREAD(p) ((uint32_t)((((p) >> 4 & 3) << 22) | (((p) >> 2 & 3) << 11) | ((p) & 3)))
+
+#define BLUR_COLUMNS 8 // columns blurred per row sweep of the vertical pass
+
+static const uint8_t bayer4[4][4] = {{0, 8, 2, 10}, {12, 4, 14, 6}, {3, 11, 1, 9}, {15, 7, 13, 5}};
+
+// box blurs len pixels from src into dst keeping a running sum of the window, so cost per pixel doesn't depend on radius
+// edges are extended by repeating first/last pixel, "other" is the coordinate across the line (used for dithering)
+static void blur_line(const uint8_t *src, uint8_t *dst, int len, int radius, uint8_t mode, int other) {
+  uint32_t n = 2*radius + 1;
+  uint32_t inv = 65536 / n;
+  uint32_t sum = 0;
+  
+  for (int i = -radius; i <= radius; i++) {
+    uint8_t p = src[i < 0 ? 0 : (i >= len ? len - 1 : i)];
+    sum += mode == BLUR_COLOR ? BLUR_SPREAD(p) : p;
+  }
+  
+  for (int i = 0; i < len; i++) {
+    if (mode == BLUR_COLOR) {
+      dst[i] = (src[i] & 0xC0) | 
+               ((((sum >> 22) * inv + 32768) >> 16) << 4) | 
+               (((((sum >> 11) & 0x7FF) * inv + 32768) >> 16) << 2) | 
+               (((sum & 0x7FF) * inv + 32768) >> 16);
+    } else {
+      dst[i] = 32*sum > n*(2*bayer4[other & 3][i & 3] + 1);
+    }
+    
+    uint8_t p_in = src[i + radius + 1 >= len ? len - 1 : i + radius + 1];
+    uint8_t p_out = src[i - radius < 0 ? 0 : i - radius];
+    sum += mode == BLUR_COLOR ? BLUR_SPREAD(p_in) - BLUR_SPREAD(p_out) : (uint32_t)p_in - p_out;
+  }
+}
+
+// blur effect.
+// Added by Grégoire Sage
+// Parameter: blur radius
+// Separable box blur - horizontal pass over rows, then vertical pass over columns, each in O(1) per pixel.
+// Scratch memory is BLUR_COLUMNS+1 lines, on 1-bit framebuffers both passes are ordered-dithered.
+void effect_blur(GContext* ctx, GRect position, void* param) {
+  // clamped before narrowing, so e.g. 300 blurs like BLUR_MAX_RADIUS instead of wrapping around
+  uint32_t param_radius = (uintptr_t)param;
+  if (param_radius == 0) return;
+  uint8_t radius = param_radius > BLUR_MAX_RADIUS ? BLUR_MAX_RADIUS : param_radius;
+  
+  //capturing framebuffer bitmap
+  GBitmap *fb = graphics_capture_frame_buffer(ctx);
+  
+  BitmapInfo bitmap_info;
+  bitmap_info_init(&bitmap_info, fb);
+  
+  // clipping to framebuffer
+  int x0 = position.origin.x < bitmap_info.bounds.origin.x ? bitmap_info.bounds.origin.x : position.origin.x;
+  int y0 = position.origin.y < bitmap_info.bounds.origin.y ? bitmap_info.bounds.origin.y : position.origin.y;
+  int x1 = position.origin.x + position.size.w;
+  int y1 = position.origin.y + position.size.h;
+  if (x1 > bitmap_info.bounds.origin.x + bitmap_info.bounds.size.w) x1 = bitmap_info.bounds.origin.x + bitmap_info.bounds.size.w;
+  if (y1 > bitmap_info.bounds.origin.y + bitmap_info.bounds.size.h) y1 = bitmap_info.bounds.origin.y + bitmap_info.bounds.size.h;
+  
+  // scratch: one line for the horizontal pass, BLUR_COLUMNS columns for the vertical one, plus the blurred line
+  int len = x1 - x0 > y1 - y0 ? x1 - x0 : y1 - y0;
+  uint8_t *cols = len > 0 ? malloc((BLUR_COLUMNS + 1) * len) : NULL;
+  if (!cols) {
+    graphics_release_frame_buffer(ctx, fb);
+    return;
+  }
+  uint8_t *dst = cols + BLUR_COLUMNS * len;
+  BitmapRow row;
+  bitmap_row_begin(&row, &bitmap_info, y0);
+  uint8_t mode = row.one_bit ? BLUR_DITHER : BLUR_COLOR;
+  
+  // horizontal pass
+  for (bitmap_row_begin(&row, &bitmap_info, y0); row.y < y1; bitmap_row_next(&row)) {
+    int a = x0 > row.min_x ? x0 : row.min_x;
+    int b = x1 <= row.max_x ? x1 : row.max_x + 1;
+    if (a >= b) continue;
+    
+    for (int x = a; x < b; x++) cols[x - a] = row.one_bit ? bitmap_row_get(&row, x) != 0 : bitmap_row_get(&row, x);
+    blur_line(cols, dst, b - a, radius, mode, row.y);
+    for (int x = a; x < b; x++) bitmap_row_set(&row, x, dst[x - a]);
+  }
+  
+  // vertical pass over strips of BLUR_COLUMNS columns, so each row is started once per strip instead of per pixel.
+  // Only pixels valid in their row are blurred (on round screen that's a contiguous run per column).
+  for (int sx = x0; sx < x1; sx += BLUR_COLUMNS) {
+    int n = x1 - sx < BLUR_COLUMNS ? x1 - sx : BLUR_COLUMNS;
+    int count[BLUR_COLUMNS] = {0};
+    
+    for (bitmap_row_begin(&row, &bitmap_info, y0); row.y < y1; bitmap_row_next(&row))
+      for (int c = 0; c < n; c++)
+        if (sx + c >= row.min_x && sx + c <= row.max_x) 
+          cols[c*len + count[c]++] = row.one_bit ? bitmap_row_get(&row, sx + c) != 0 : bitmap_row_get(&row, sx + c);
+    
+    for (int c = 0; c < n; c++) {
+      if (count[c] == 0) continue;
+      blur_line(cols + c*len, dst, count[c], radius, mode, sx + c);
+      memcpy(cols + c*len, dst, count[c]);
+      count[c] = 0;
+    }
+    
+    for (bitmap_row_begin(&row, &bitmap_info, y0); row.y < y1; bitmap_row_next(&row))
+      for (int c = 0; c < n; c++)
+        if (sx + c >= row.min_x && sx + c <= row.max_x) bitmap_row_set(&row, sx + c, cols[c*len + count[c]++]);
+  }
+  
+  free(cols);
+  graphics_release_frame_buffer(ctx, fb);
+}
+
+// source columns of the zoom for each side of the centre, clipped to the layer rect
+typedef struct {
+  int16_t *right; // right[xS] - source column for column xCn + xS
+  int16_t *left;  // left[xS] - source column for column xCn - xS
+  int16_t right_len;
+  int16_t left_len;
+  bool outward;   // zooming in - columns have to be scanned from the edge towards centre
+} ZoomColumns;
+
+// resamples one row of the zoom from src row into dst row
+static void zoom_row(BitmapRow *dst, BitmapRow *src, int xCn, const ZoomColumns *columns) {
+  for (int i = 0; i < columns->right_len; i++) {
+    int xS = columns->outward ? columns->right_len - 1 - i : i;
+    bitmap_row_set(dst, xCn + xS, bitmap_row_get(src, columns->right[xS]));
+  }
+  for (int i = 0; i < columns->left_len; i++) {
+    int xS = columns->outward ? columns->left_len - 1 - i : i;
+    bitmap_row_set(dst, xCn - xS, bitmap_row_get(src, columns->left[xS]));
+  }
+}
+
+// zooms rows from..extent away from the centre on one side of it (dir = 1 below, dir = -1 above)
+// consecutive rows reading the same source row are copied from the previous row instead of being resampled again
+static void zoom_rows(BitmapInfo *bitmap_info, int xCn, int yCn, int dir, int from, int extent, uint8_t ratioY, const ZoomColumns *columns) {
+  BitmapRow dst, src, last = { 0 }; // last is only read once a row was zoomed (Y1 == last_Y1)
+  int last_Y1 = -1;
+  int x0 = xCn - columns->left_len + 1, x1 = xCn + columns->right_len;
+  
+  for (int i = from; i <= extent; i++) {
+    //yS scan source: centre to out or out to centre
+    int yS = ratioY > 16 ? extent + from - i : i;
+    int Y1 = (yS << 4) / ratioY;
+    if (Y1 > extent) Y1 = extent;
+    
+    bitmap_row_begin(&dst, bitmap_info, yCn + dir*yS);
+    if (Y1 == last_Y1) {
+      bitmap_row_copy_span(&dst, &last, x0, x1);
+    } else {
+      bitmap_row_begin(&src, bitmap_info, yCn + dir*Y1);
+      zoom_row(&dst, &src, xCn, columns);
+    }
+    last = dst;
+    last_Y1 = Y1;
+  }
+}
+
 // Zoom effect.
 // Added by Ron64
 // Parameter: Y zoom (high byte) X zoom(low byte),  0x10 no zoom 0x20 200% 0x08 50%, 
 // use the percentage macro EL_ZOOM(150,60). In this example: Y- zoom in 150%, X- zoom out to 60% 
+// Source columns are mapped once per call, rows that repeat a source row are copied and reads are clipped to the layer rect.
 void effect_zoom(GContext* ctx,  GRect position, void* param){
+  uint8_t ratioY= (int32_t)(intptr_t)param >>8 & 0xFF;
+  uint8_t ratioX= (int32_t)(intptr_t)param & 0xFF;
+  if (ratioX == 0 || ratioY == 0 || position.size.w <= 0 || position.size.h <= 0) return;
+  
+  int xCn= position.origin.x + position.size.w /2;
+  int yCn= position.origin.y + position.size.h /2;
+  
+  // number of columns/rows from the centre to each edge of the rect
+  ZoomColumns columns;
+  columns.right_len = position.origin.x + position.size.w - xCn;
+  columns.left_len = xCn - position.origin.x + 1;
+  columns.outward = ratioX > 16;
+  columns.right = malloc((columns.right_len + columns.left_len) * sizeof(int16_t));
+  if (!columns.right) return;
+  columns.left = columns.right + columns.right_len;
+  
+  for (int xS = 0; xS < columns.right_len; xS++) {
+    int X1 = (xS << 4) / ratioX;
+    columns.right[xS] = xCn + (X1 < columns.right_len ? X1 : columns.right_len - 1);
+  }
+  for (int xS = 0; xS < columns.left_len; xS++) {
+    int X1 = (xS << 4) / ratioX;
+    columns.left[xS] = xCn - (X1 < columns.left_len ? X1 : columns.left_len - 1);
+  }
+  
   GBitmap *fb = graphics_capture_frame_buffer(ctx);
   
   BitmapInfo bitmap_info;
-  bitmap_info.bitmap = fb;
-  bitmap_info.bitmap_data =  gbitmap_get_data(fb);
-  bitmap_info.bytes_per_row = gbitmap_get_bytes_per_row(fb);
-  bitmap_info.bitmap_format = gbitmap_get_format(fb);
+  bitmap_info_init(&bitmap_info, fb);
+  
+  // centre row belongs to the lower half, upper half goes first as it still reads the centre row when zooming in
+  zoom_rows(&bitmap_info, xCn, yCn, -1, 1, yCn - position.origin.y, ratioY, &columns);
+  zoom_rows(&bitmap_info, xCn, yCn, 1, 0, position.origin.y + position.size.h - 1 - yCn, ratioY, &columns);
+  
+  graphics_release_frame_buffer(ctx, fb);
+  free(columns.right);
+}
 
-  uint8_t xCn, yCn, Y1,X1, ratioY, ratioX;
-  xCn= position.origin.x + position.size.w /2;
-  yCn= position.origin.y + position.size.h /2;
+// displacement table of the lens, owned by effect_lens and rebuilt only when focal, distance or radius change
+static struct {
+  uint8_t focal;
+  uint8_t obj_dis;
+  uint8_t radius;
+  int16_t *shift; // shift[i] - distance from lens centre to read pixel i from
+} s_lens_cache;
 
-  ratioY= (int32_t)param >>8 & 0xFF;
-  ratioX= (int32_t)param & 0xFF;
-
-  for (int y = 0; y <= position.size.h>>1; y++)
-    for (int x = 0; x <= position.size.w>>1; x++)
-    {
-      //yS,xS scan source: centre to out or out to centre
-      int8_t yS = (ratioY>16) ? (position.size.h/2)- y: y; 
-      int8_t xS = (ratioX>16) ? (position.size.w/2)- x: x;
-      Y1= (yS<<4) /ratioY;
-      X1= (xS<<4) /ratioX;
-      set_pixel(bitmap_info, yCn +yS, xCn +xS, get_pixel(bitmap_info, yCn +Y1, xCn +X1)); 
-      set_pixel(bitmap_info, yCn +yS, xCn -xS, get_pixel(bitmap_info, yCn +Y1, xCn -X1));
-      set_pixel(bitmap_info, yCn -yS, xCn +xS, get_pixel(bitmap_info, yCn -Y1, xCn +X1));
-      set_pixel(bitmap_info, yCn -yS, xCn -xS, get_pixel(bitmap_info, yCn -Y1, xCn -X1));
-    }
-  graphics_release_frame_buffer(ctx, fb);
-//Todo: Should probably reduce Y size on zoom out or limit reading beyond edge of screen.
+// returns displacement table for given lens (NULL if out of memory)
+static int16_t* lens_get_shift(uint8_t focal, uint8_t obj_dis, uint8_t radius) {
+  if (s_lens_cache.shift && s_lens_cache.focal == focal && s_lens_cache.obj_dis == obj_dis && s_lens_cache.radius == radius)
+    return s_lens_cache.shift;
+  
+  free(s_lens_cache.shift);
+  s_lens_cache.shift = malloc((radius + 1) * sizeof(int16_t));
+  if (!s_lens_cache.shift) return NULL;
+  
+  s_lens_cache.focal = focal;
+  s_lens_cache.obj_dis = obj_dis;
+  s_lens_cache.radius = radius;
+  for (int i = 0; i <= radius; i++) 
+    if (i < focal) {
+      int64_t shift = ((int64_t)fx_tan(fx_asin((i << 16) / focal)) * obj_dis) >> 16;
+      s_lens_cache.shift[i] = shift < INT16_MAX ? shift : INT16_MAX;
+    } else // asin is undefined past the focal point - lens doesn't bend there
+      s_lens_cache.shift[i] = i;
+  
+  return s_lens_cache.shift;
+}
+
+void effect_lens_release(void) {
+  free(s_lens_cache.shift);
+  s_lens_cache.shift = NULL;
 }
 
 // Lens effect.
 // Added by Ron64
 // Parameters: lens focal(high byte) and object distance(low byte)
+// Displacement depends only on distance from the centre along each axis, so it is computed once per lens into a
+// table of radius+1 entries and every frame after that costs one lookup per axis, mirrored to all four quadrants.
 void effect_lens(GContext* ctx,  GRect position, void* param){
-  GBitmap *fb = graphics_capture_frame_buffer(ctx);
-  
-  BitmapInfo bitmap_info;
-  bitmap_info.bitmap = fb;
-  bitmap_info.bitmap_data =  gbitmap_get_data(fb);
-  bitmap_info.bytes_per_row = gbitmap_get_bytes_per_row(fb);
-  bitmap_info.bitmap_format = gbitmap_get_format(fb);
-  
-  uint8_t d,r, xCn, yCn;
+  uint8_t d,r;
+  int xCn, yCn;
 
   xCn= position.origin.x + position.size.w /2;
   yCn= position.origin.y + position.size.h /2;
@@ -605,28 +866,60 @@ void effect_lens(GContext* ctx,  GRect position, void* param){
   if (position.size.h < d)
     d= position.size.h;
   r= d/2; // radius of lens
-  float focal =   (int32_t)param >>8 & 0xFF;// focal point of lens
-  float obj_dis = (int32_t)param & 0xFF;//distance of object from focal point.
-  
-  for (int y = r; y >= 0; --y)
-    for (int x = r; x >= 0; --x)
-      if (x*x+y*y < r*r)
-      {
-        int Y1= my_tan(my_asin(y/focal))*obj_dis;
-        int X1= my_tan(my_asin(x/focal))*obj_dis;
-        set_pixel(bitmap_info, yCn +y, xCn +x, get_pixel(bitmap_info, yCn +Y1, xCn +X1)); 
-        set_pixel(bitmap_info, yCn +y, xCn -x, get_pixel(bitmap_info, yCn +Y1, xCn -X1));
-        set_pixel(bitmap_info, yCn -y, xCn +x, get_pixel(bitmap_info, yCn -Y1, xCn +X1));
-        set_pixel(bitmap_info, yCn -y, xCn -x, get_pixel(bitmap_info, yCn -Y1, xCn -X1));
-      }
-    graphics_release_frame_buffer(ctx, fb);
-//Todo: Change to lock-up arcsin table in the future. (Currently using floating point math library that is relatively big & slow)
+  uint8_t focal =   (int32_t)(intptr_t)param >>8 & 0xFF;// focal point of lens
+  uint8_t obj_dis = (int32_t)(intptr_t)param & 0xFF;//distance of object from focal point.
+  
+  int16_t *shift = lens_get_shift(focal, obj_dis, r);
+  if (!shift) return;
+  
+  GBitmap *fb = graphics_capture_frame_buffer(ctx);
+  
+  BitmapInfo bitmap_info;
+  bitmap_info_init(&bitmap_info, fb);
+  
+  BitmapRow dst_below, dst_above, src_below, src_above;
+  int x_max = -1; // last column inside the lens for current row
+  
+  for (int y = r; y >= 0; --y) {
+    while ((x_max+1)*(x_max+1) + y*y < r*r) x_max++;
+    
+    int Y1= shift[y];
+    bitmap_row_begin(&dst_below, &bitmap_info, yCn +y);
+    bitmap_row_begin(&dst_above, &bitmap_info, yCn -y);
+    bitmap_row_begin(&src_below, &bitmap_info, yCn +Y1);
+    bitmap_row_begin(&src_above, &bitmap_info, yCn -Y1);
+    
+    for (int x = x_max; x >= 0; --x) {
+      int X1= shift[x];
+      bitmap_row_set(&dst_below, xCn +x, bitmap_row_get(&src_below, xCn +X1)); 
+      bitmap_row_set(&dst_below, xCn -x, bitmap_row_get(&src_below, xCn -X1));
+      bitmap_row_set(&dst_above, xCn +x, bitmap_row_get(&src_above, xCn +X1));
+      bitmap_row_set(&dst_above, xCn -x, bitmap_row_get(&src_above, xCn -X1));
+    }
+  }
+  
+  graphics_release_frame_buffer(ctx, fb);
 }
   
+// builds 256 bit membership set of framebuffer pixel values matching GColorClear terminated array of mask colors
+static void mask_build_set(GColor *colors, uint32_t *set) {
+  memset(set, 0, 8 * sizeof(uint32_t));
+  for (int i = 0; !gcolor_equal(colors[i], GColorClear); i++) {
+    #ifdef PBL_COLOR
+      uint8_t pixel = colors[i].argb;
+    #else
+      uint8_t pixel = gcolor_equal(colors[i], GColorWhite)? 1 : 0;
+    #endif
+    set[pixel >> 5] |= 1u << (pixel & 31);
+  }
+}
+
 // mask effect.
 // see struct EffectMask for parameter description  
+// Mask colors are turned into a membership set once per call and background pixels go through a conversion table
+// cached per pair of bitmap formats, so every pixel costs a bit test, and runs of masked pixels are copied from the
+// background a row span at a time.
 void effect_mask(GContext* ctx, GRect position, void* param) {
-  GColor temp_pixel;  
   EffectMask *mask = (EffectMask *)param;
 
   //drawing background - only if real color is passed
@@ -647,28 +940,57 @@ void effect_mask(GContext* ctx, GRect position, void* param) {
   GBitmap *fb = graphics_capture_frame_buffer(ctx);
   
   BitmapInfo bitmap_info;
-  bitmap_info.bitmap = fb;
-  bitmap_info.bitmap_data =  gbitmap_get_data(fb);
-  bitmap_info.bytes_per_row = gbitmap_get_bytes_per_row(fb);
-  bitmap_info.bitmap_format = gbitmap_get_format(fb);
+  bitmap_info_init(&bitmap_info, fb);
   
   //capturing background bitmap
   BitmapInfo bg_bitmap_info;
-  bg_bitmap_info.bitmap = mask->bitmap_background;
-  bg_bitmap_info.bitmap_data =  gbitmap_get_data(mask->bitmap_background);
-  bg_bitmap_info.bytes_per_row =  gbitmap_get_bytes_per_row(mask->bitmap_background);
-  bg_bitmap_info.bitmap_format = gbitmap_get_format(mask->bitmap_background);
+  bitmap_info_init(&bg_bitmap_info, mask->bitmap_background);
   
-  //looping throughout layer replacing mask with bg bitmap
-  for (int y = 0; y < position.size.h; y++)
-     for (int x = 0; x < position.size.w; x++) {
-      temp_pixel = (GColor)get_pixel(bitmap_info, y + position.origin.y, x + position.origin.x);
-       if ( gcolor_contains(mask->mask_colors, temp_pixel)) { // if array of mask colors matches current screen pixel color:
-         // getting pixel from background bitmap (adjusted to pallette by PalColor function because palette of bg bitmap and framebuffer may differ)
-         // YG OCT-25-2015: replaced "y + position.origin.y, x + position.origin.x" with "y + 0, x + 0" since in mask bitmap we start without offset
-         set_pixel(bitmap_info, y + position.origin.y, x + position.origin.x, PalColor(get_pixel(bg_bitmap_info, y + 0, x + 0), bg_bitmap_info.bitmap_format, bitmap_info.bitmap_format));
-       } 
+  uint32_t mask_set[8];
+  mask_build_set(mask->mask_colors, mask_set);
+  
+  // background pixel adjusted to pallette of the framebuffer (palette of bg bitmap and framebuffer may differ),
+  // the table depends only on the two formats and is rebuilt when they change
+  static uint8_t conv[256];
+  static int conv_formats = -1;
+  int formats = bg_bitmap_info.bitmap_format << 8 | bitmap_info.bitmap_format;
+  if (formats != conv_formats) {
+    for (int c = 0; c < 256; c++) conv[c] = PalColor(c, bg_bitmap_info.bitmap_format, bitmap_info.bitmap_format);
+    conv_formats = formats;
+  }
   
+  BitmapRow row, bg_row;
+  
+  //looping throughout layer replacing mask with bg bitmap
+  for (int y = 0; y < position.size.h; y++) {
+     bitmap_row_begin(&row, &bitmap_info, y + position.origin.y);
+     // YG OCT-25-2015: replaced "y + position.origin.y, x + position.origin.x" with "y + 0, x + 0" since in mask bitmap we start without offset
+     bitmap_row_begin(&bg_row, &bg_bitmap_info, y + 0);
+     
+     int x0 = position.origin.x > row.min_x ? position.origin.x : row.min_x;
+     int x1 = position.origin.x + position.size.w <= row.max_x ? position.origin.x + position.size.w : row.max_x + 1;
+     
+     for (int x = x0; x < x1; x++) {
+       uint8_t pixel = bitmap_row_get(&row, x);
+       if (!(mask_set[pixel >> 5] & (1u << (pixel & 31)))) continue;
+       
+       // run of pixels matching mask colors
+       int end = x + 1;
+       while (end < x1) {
+         pixel = bitmap_row_get(&row, end);
+         if (!(mask_set[pixel >> 5] & (1u << (pixel & 31)))) break;
+         end++;
+       }
+       
+       // bg bitmap starts at layer origin
+       int bg_x0 = x - position.origin.x, bg_x1 = end - position.origin.x;
+       if (!row.one_bit && !bg_row.one_bit && bg_x0 >= bg_row.min_x && bg_x1 <= bg_row.max_x + 1)
+         memcpy(row.data + x, bg_row.data + bg_x0, end - x); // 8-bit rows need no conversion
+       else
+         for (int i = x; i < end; i++) bitmap_row_set(&row, i, conv[bitmap_row_get(&bg_row, i - position.origin.x)]);
+       
+       x = end;
+     }
   }
   
   graphics_release_frame_buffer(ctx, fb);
@@ -685,7 +1007,7 @@ void effect_fps(GContext* ctx, GRect position, void* param) {
     time_ms(&tt,&ms);
     ++((EffectFPS*)param)->frame;
     uint32_t fp100s = (100000*((EffectFPS*)param)->frame)/((tt-((EffectFPS*)param)->starttt)*1000+ms-((EffectFPS*)param)->startms);
-    snprintf(buff,sizeof(buff),"FPS:%d.%02d",(int)fp100s/100,(int)fp100s%100);
+    snprintf(buff,sizeof(buff),"FPS:%u.%02u",(unsigned)(fp100s/100),(unsigned)(fp100s%100));
     graphics_context_set_stroke_color(ctx, GColorWhite);
     graphics_draw_text(ctx, buff, font, GRect(0, 0, position.size.w, position.size.h), GTextOverflowModeWordWrap, GTextAlignmentLeft, NULL);
   }
@@ -697,119 +1019,308 @@ void effect_fps(GContext* ctx, GRect position, void* param) {
   }
 }
 
+// histogram bucket of given time - bucket b holds times in [2^b, 2^(b+1)) ms, 0 and 1 ms go to bucket 0
+static uint8_t frame_stats_bucket(uint32_t ms) {
+  uint8_t b = 0;
+  while (ms > 1 && b < FRAME_STATS_BUCKETS - 1) {
+    ms >>= 1;
+    b++;
+  }
+  return b;
+}
+
+// upper bound of the bucket holding given percentile of the histogram (clamped to the maximum seen)
+static uint32_t frame_stats_percentile(const uint16_t *hist, uint32_t count, uint8_t pct, uint32_t max) {
+  uint32_t sum = 0;
+  for (int b = 0; b < FRAME_STATS_BUCKETS; b++) {
+    sum += hist[b];
+    if (sum * 100 >= pct * count) {
+      uint32_t bound = (2u << b) - 1;
+      return bound < max ? bound : max;
+    }
+  }
+  return max;
+}
+
+static void frame_stats_add(uint16_t *hist, uint16_t *min, uint16_t *max, uint32_t count, uint32_t ms) {
+  if (ms > UINT16_MAX) ms = UINT16_MAX;
+  uint8_t b = frame_stats_bucket(ms);
+  if (hist[b] < UINT16_MAX) hist[b]++;
+  if (count == 0 || ms < *min) *min = ms;
+  if (ms > *max) *max = ms;
+}
+
+void effect_frame_stats_mark(GContext* ctx, GRect position, void* param) {
+  ((EffectFrameStats*)param)->render_start = clock_ms();
+}
+
+void effect_frame_stats(GContext* ctx, GRect position, void* param) {
+  static GFont font = NULL;
+  static char buff[96];
+  EffectFrameStats *stats = (EffectFrameStats*)param;
+  uint32_t now = clock_ms();
+  
+  if (!font) font = fonts_get_system_font(FONT_KEY_GOTHIC_14);
+  
+  if (stats->render_start) {
+    frame_stats_add(stats->render_hist, &stats->render_min, &stats->render_max, stats->renders, now - stats->render_start);
+    stats->renders++;
+    stats->render_start = 0;
+  }
+  
+  if (stats->prev_frame) {
+    uint32_t ms = now - stats->prev_frame;
+    frame_stats_add(stats->frame_hist, &stats->frame_min, &stats->frame_max, stats->frames, ms);
+    stats->frames++;
+    stats->last[stats->next_last] = ms > UINT16_MAX ? UINT16_MAX : ms;
+    stats->next_last = (stats->next_last + 1) % FRAME_STATS_LAST;
+  }
+  stats->prev_frame = now;
+  if (!stats->frames) return;
+  
+  int len = snprintf(buff, sizeof(buff), "F %d/%d/%d/%d\nR %d/%d/%d/%d\n",
+    stats->frame_min, (int)frame_stats_percentile(stats->frame_hist, stats->frames, 50, stats->frame_max),
+    (int)frame_stats_percentile(stats->frame_hist, stats->frames, 95, stats->frame_max), stats->frame_max,
+    stats->render_min, (int)frame_stats_percentile(stats->render_hist, stats->renders, 50, stats->render_max),
+    (int)frame_stats_percentile(stats->render_hist, stats->renders, 95, stats->render_max), stats->render_max);
+  
+  // last frames, newest first
+  uint32_t shown = stats->frames < FRAME_STATS_LAST ? stats->frames : FRAME_STATS_LAST;
+  for (uint32_t n = 1; n <= shown && len < (int)sizeof(buff); n++)
+    len += snprintf(buff + len, sizeof(buff) - len, "%d ", stats->last[(stats->next_last + FRAME_STATS_LAST - n) % FRAME_STATS_LAST]);
+  
+  graphics_context_set_text_color(ctx, GColorWhite);
+  graphics_draw_text(ctx, buff, font, GRect(0, 0, position.size.w, position.size.h), GTextOverflowModeWordWrap, GTextAlignmentLeft, NULL);
+}
+
+void effect_frame_stats_reset(EffectFrameStats *stats) {
+  memset(stats, 0, sizeof(EffectFrameStats));
+}
+
+
+// one pixel of the long shadow sweep at x of row, d - steps from the object at the previous pixel of the ray,
+// returns the steps at this pixel
+static inline int shadow_long_pixel(BitmapRow *row, int x, int d, bool in_rect, int length, uint8_t orig, uint8_t draw) {
+  if (d < 0xFF) d++;
+  int pixel = (x < row->min_x || x > row->max_x) ? -1 : bitmap_row_get(row, x);
+  if (pixel == orig) {
+    if (in_rect) d = 0;
+  } else if (d <= length && pixel >= 0) {
+    #ifdef PBL_COLOR
+      if (pixel != draw) bitmap_row_set(row, x, draw);
+    #else // alternating pixels for "lined" effect
+      bitmap_row_set(row, x, d & 1 ? 1 - draw : draw);
+    #endif
+  }
+  return d;
+}
+
+// minor step (0 or 1) of the shadow ray from major step t-1 to t, dec - 8.8 minor advance per major step
+static inline int shadow_jump(int t, int dec) {
+  return t == 0 ? 0 : ((0x80 + t*dec) >> 8) - ((0x80 + (t-1)*dec) >> 8);
+}
+
+// Long shadow is swept along the major axis of the offset (u, v along the minor one). All shadow rays follow the same
+// digital line: stepping from u to the next one the ray moves shadow_jump() = 0 or 1 pixels along v, and the distance from
+// the nearest orig_color pixel up the ray grows by one. Pixels 1..length steps from the object get painted.
+// Only one row cursor is live: with a vertical major axis each u is a row and dist[v] carries the ray distances from
+// row to row, with a horizontal one the rows are walked in the minor direction so the ray's previous pixel is in the
+// same or the previous row, whose distances are kept per column.
+static void shadow_long(BitmapInfo *bitmap_info, GRect position, EffectOffset *shadow, uint8_t orig, uint8_t draw) {
+  GRect bounds = bitmap_info->bounds;
+  bool x_major = abs(shadow->offset_x) >= abs(shadow->offset_y);
+  int major = x_major ? shadow->offset_x : shadow->offset_y;
+  int minor = x_major ? shadow->offset_y : shadow->offset_x;
+  int length = abs(major);
+  if (length == 0) return;
+  
+  int step = major > 0 ? 1 : -1;
+  int minor_step = minor > 0 ? 1 : -1;
+  int dec = (abs(minor) << 8) / length; // 8.8 minor advance per major step
+  
+  // layer rect and framebuffer size in (u, v) coordinates
+  int u_n = x_major ? bounds.size.w : bounds.size.h;
+  int v_n = x_major ? bounds.size.h : bounds.size.w;
+  int ru0 = (x_major ? position.origin.x - bounds.origin.x : position.origin.y - bounds.origin.y);
+  int rv0 = (x_major ? position.origin.y - bounds.origin.y : position.origin.x - bounds.origin.x);
+  int ru1 = ru0 + (x_major ? position.size.w : position.size.h);
+  int rv1 = rv0 + (x_major ? position.size.h : position.size.w);
+  
+  // sweep from the first rect column in offset direction till the shadow of the last one ends
+  int lo = step > 0 ? ru0 : ru0 - length;
+  int hi = step > 0 ? ru1 - 1 + length : ru1 - 1;
+  if (lo < 0) lo = 0;
+  if (hi > u_n - 1) hi = u_n - 1;
+  if (lo > hi) return;
+  int first = step > 0 ? lo : hi;
+  int last = step > 0 ? hi : lo;
+  
+  BitmapRow row;
+  
+  if (x_major) {
+    // distances of the previous and the current row, per column
+    uint8_t *dist = malloc(2 * u_n);
+    if (!dist) return;
+    uint8_t *prev = dist, *cur = dist + u_n;
+    memset(prev, 0xFF, u_n); // no object up the ray
+    
+    for (int k = 0; k < v_n; k++) {
+      int v = minor_step > 0 ? k : v_n - 1 - k;
+      bool in_rect = v >= rv0 && v < rv1;
+      bitmap_row_begin(&row, bitmap_info, v + bounds.origin.y);
+      
+      for (int u = first, t = 0; u != last + step; u += step, t++) {
+        int d = t == 0 ? 0xFF : shadow_jump(t, dec) ? prev[u - step] : cur[u - step];
+        cur[u] = shadow_long_pixel(&row, u + bounds.origin.x, d, in_rect && u >= ru0 && u < ru1, length, orig, draw);
+      }
+      
+      uint8_t *swap = prev; prev = cur; cur = swap;
+    }
+    
+    free(dist);
+  } else {
+    uint8_t *dist = malloc(v_n);
+    if (!dist) return;
+    memset(dist, 0xFF, v_n); // no object up the ray
+    
+    for (int u = first, t = 0; u != last + step; u += step, t++) {
+      // dist is shifted in place by the ray's minor step in the direction that reads old values
+      int delta = minor_step * shadow_jump(t, dec);
+      bool in_rect = u >= ru0 && u < ru1;
+      bitmap_row_begin(&row, bitmap_info, u + bounds.origin.y);
+      
+      for (int k = 0; k < v_n; k++) {
+        int v = delta > 0 ? v_n - 1 - k : k;
+        int d = (v - delta >= 0 && v - delta < v_n) ? dist[v - delta] : 0xFF;
+        dist[v] = shadow_long_pixel(&row, v + bounds.origin.x, d, in_rect && v >= rv0 && v < rv1, length, orig, draw);
+      }
+    }
+    
+    free(dist);
+  }
+}
 
 // shadow effect.
 // see struct EffecOffset for parameter description  
 void effect_shadow(GContext* ctx, GRect position, void* param) {
-  GColor temp_pixel;  
-  int shadow_x, shadow_y;
   EffectOffset *shadow = (EffectOffset *)param;
   
-  #ifndef PBL_COLOR
-    uint8_t draw_color = gcolor_equal(shadow->offset_color, GColorWhite)? 1 : 0;
-    uint8_t skip_color = gcolor_equal(shadow->orig_color, GColorWhite)? 1 : 0;
+  #ifdef PBL_COLOR
+    uint8_t orig = shadow->orig_color.argb;
+    uint8_t draw = shadow->offset_color.argb;
+  #else
+    uint8_t orig = gcolor_equal(shadow->orig_color, GColorWhite)? 1 : 0;
+    uint8_t draw = gcolor_equal(shadow->offset_color, GColorWhite)? 1 : 0;
   #endif
+  if (orig == draw) return;
   
    //capturing framebuffer bitmap
   GBitmap *fb = graphics_capture_frame_buffer(ctx);
   
   BitmapInfo bitmap_info;
-  bitmap_info.bitmap = fb;
-  bitmap_info.bitmap_data =  gbitmap_get_data(fb);
-  bitmap_info.bytes_per_row = gbitmap_get_bytes_per_row(fb);
-  bitmap_info.bitmap_format = gbitmap_get_format(fb);
-
+  bitmap_info_init(&bitmap_info, fb);
   
-  //looping throughout making shadow
-  for (int y = 0; y < position.size.h; y++)
-     for (int x = 0; x < position.size.w; x++) {
-       temp_pixel = (GColor)get_pixel(bitmap_info, y + position.origin.y, x + position.origin.x);
-       
-       if (gcolor_equal(temp_pixel, shadow->orig_color)) {
-         shadow_x =  x + position.origin.x + shadow->offset_x;
-         shadow_y =  y + position.origin.y + shadow->offset_y;
-         
-         if (shadow->option == 1) {
-            #ifdef PBL_COLOR // for Basalt simple calling line-drawing routine
-               set_line(bitmap_info, y + position.origin.y, x + position.origin.x, shadow_y, shadow_x, shadow->offset_color.argb, shadow->orig_color.argb, NULL);
-            #else // for Aplite - passing user-defined array to determine if pixels have been set or not
-               set_line(bitmap_info, y + position.origin.y, x + position.origin.x, shadow_y, shadow_x, draw_color, skip_color, shadow->aplite_visited); 
-            #endif
-           
-         } else {
-           
-             if (shadow_x >= 0 && shadow_x <=143 && shadow_y >= 0 && shadow_y <= 167) {
-             
-               temp_pixel = (GColor)get_pixel(bitmap_info, shadow_y, shadow_x);
-               if (!gcolor_equal(temp_pixel, shadow->orig_color) & !gcolor_equal(temp_pixel, shadow->offset_color) ) {
-                 #ifdef PBL_COLOR
-                    set_pixel(bitmap_info,  shadow_y, shadow_x, shadow->offset_color.argb);  
-                 #else
-                    set_pixel(bitmap_info,  shadow_y, shadow_x, gcolor_equal(shadow->offset_color, GColorWhite)? 1 : 0);
-                 #endif
-               }
-             }
-           
-         }
-         
-         
-       }
+  if (shadow->option == 1) {
+    shadow_long(&bitmap_info, position, shadow, orig, draw);
+  } else {
+    BitmapRow row, shadow_row;
+    
+    for (int y = position.origin.y; y < position.origin.y + position.size.h; y++) {
+      bitmap_row_begin(&row, &bitmap_info, y);
+      bitmap_row_begin(&shadow_row, &bitmap_info, y + shadow->offset_y);
+      
+      for (int x = position.origin.x; x < position.origin.x + position.size.w; x++) {
+        if (bitmap_row_get(&row, x) != orig) continue;
+        
+        int shadow_x = x + shadow->offset_x;
+        if (shadow_x < shadow_row.min_x || shadow_x > shadow_row.max_x) continue;
+        
+        uint8_t pixel = bitmap_row_get(&shadow_row, shadow_x);
+        if (pixel != orig && pixel != draw)
+          bitmap_row_set(&shadow_row, shadow_x, draw);
+      }
+    }
   }
-         
+  
   graphics_release_frame_buffer(ctx, fb);
- 
 }
 
+// adds (dir = 1) or removes (dir = -1) mask pixels of source row y to per column counters
+// count[0] is the counter of column x0
+static void outline_count_row(BitmapInfo *bitmap_info, int y, int x0, int x1, uint8_t orig, int dir, uint16_t *count) {
+  BitmapRow row;
+  bitmap_row_begin(&row, bitmap_info, y);
+  for (int x = x0 > row.min_x ? x0 : row.min_x; x < x1 && x <= row.max_x; x++)
+    if (bitmap_row_get(&row, x) == orig) count[x - x0] += dir;
+}
+
+// Outline is a binary dilation of the orig_color mask by a (2*offset_x+1) x (2*offset_y+1) box, painted only on pixels
+// outside the mask. The box is separable: a running count of mask pixels per column over the vertical window, then
+// a running count of non-empty columns over the horizontal window, so the cost doesn't depend on the outline thickness.
+// Painting never touches mask pixels, so rows leaving the vertical window are counted off from the framebuffer as is.
 void effect_outline(GContext* ctx, GRect position, void* param) {
-  GColor temp_pixel;  
-  int outlinex[8];
-  int outliney[8];
   EffectOffset *outline = (EffectOffset *)param;
+  int ox = outline->offset_x, oy = outline->offset_y;
+  
+  #ifdef PBL_COLOR
+    uint8_t orig = outline->orig_color.argb;
+    uint8_t draw = outline->offset_color.argb;
+  #else
+    uint8_t orig = gcolor_equal(outline->orig_color, GColorWhite)? 1 : 0;
+    uint8_t draw = gcolor_equal(outline->offset_color, GColorWhite)? 1 : 0;
+  #endif
+  if (ox < 0 || oy < 0 || orig == draw) return;
   
    //capturing framebuffer bitmap
   GBitmap *fb = graphics_capture_frame_buffer(ctx);
   
   BitmapInfo bitmap_info;
-  bitmap_info.bitmap = fb;
-  bitmap_info.bitmap_data =  gbitmap_get_data(fb);
-  bitmap_info.bytes_per_row = gbitmap_get_bytes_per_row(fb);
-  bitmap_info.bitmap_format = gbitmap_get_format(fb);
-
+  bitmap_info_init(&bitmap_info, fb);
+  GRect bounds = bitmap_info.bounds;
   
-  //loop through pixels from framebuffer
-  for (int y = 0; y < position.size.h; y++)
-    for (int x = 0; x < position.size.w; x++) {
-      for (int a = 0; a <= outline->offset_x; a++) 
-        for (int b = 0; b <= outline->offset_y; b++) {
+  // source pixels - layer rect clipped to the framebuffer
+  int sx0 = position.origin.x > bounds.origin.x ? position.origin.x : bounds.origin.x;
+  int sy0 = position.origin.y > bounds.origin.y ? position.origin.y : bounds.origin.y;
+  int sx1 = position.origin.x + position.size.w < bounds.origin.x + bounds.size.w ? position.origin.x + position.size.w : bounds.origin.x + bounds.size.w;
+  int sy1 = position.origin.y + position.size.h < bounds.origin.y + bounds.size.h ? position.origin.y + position.size.h : bounds.origin.y + bounds.size.h;
   
-          temp_pixel = (GColor)get_pixel(bitmap_info, y + position.origin.y, x + position.origin.x);
-       
-          if (gcolor_equal(temp_pixel, outline->orig_color)) {
-            outlinex[0] = x + position.origin.x - a;
-            outliney[0] = y + position.origin.y - b;
-            outlinex[1] = x + position.origin.x + a;
-            outliney[1] = y + position.origin.y + b;
-            outlinex[2] = x + position.origin.x - a;
-            outliney[2] = y + position.origin.y + b;
-            outlinex[3] = x + position.origin.x + a;
-            outliney[3] = y + position.origin.y - b;
-         
-            for (int i = 0; i < 4; i++) {
-              // TODO: centralize the constants
-              if (outlinex[i] >= 0 && outlinex[i] <=144 && outliney[i] >= 0 && outliney[i] <= 168) {
-                temp_pixel = (GColor)get_pixel(bitmap_info, outliney[i], outlinex[i]);
-                if (!gcolor_equal(temp_pixel, outline->orig_color)) {
-                  #ifdef PBL_COLOR
-                    set_pixel(bitmap_info, outliney[i], outlinex[i], outline->offset_color.argb);  
-                  #else
-                    set_pixel(bitmap_info, outliney[i], outlinex[i], gcolor_equal(outline->offset_color, GColorWhite)? 1 : 0);
-                  #endif
-                }
-              }
-            }
-          }
-        }
+  // painted pixels - source expanded by the offset, clipped to the framebuffer
+  int tx0 = sx0 - ox > bounds.origin.x ? sx0 - ox : bounds.origin.x;
+  int ty0 = sy0 - oy > bounds.origin.y ? sy0 - oy : bounds.origin.y;
+  int tx1 = sx1 + ox < bounds.origin.x + bounds.size.w ? sx1 + ox : bounds.origin.x + bounds.size.w;
+  int ty1 = sy1 + oy < bounds.origin.y + bounds.size.h ? sy1 + oy : bounds.origin.y + bounds.size.h;
+  
+  uint16_t *count = (sx0 < sx1 && sy0 < sy1) ? calloc(tx1 - tx0, sizeof(uint16_t)) : NULL;
+  if (!count) {
+    graphics_release_frame_buffer(ctx, fb);
+    return;
+  }
+  BitmapRow row;
+  int added = sy0, removed = sy0; // source rows [removed, added) are in the column counts
+  
+  for (int y = ty0; y < ty1; y++) {
+    for (; added < sy1 && added <= y + oy; added++)
+      outline_count_row(&bitmap_info, added, sx0, sx1, orig, 1, count + sx0 - tx0);
+    for (; removed < added && removed < y - oy; removed++)
+      outline_count_row(&bitmap_info, removed, sx0, sx1, orig, -1, count + sx0 - tx0);
+    if (removed == added) continue;
+    
+    bitmap_row_begin(&row, &bitmap_info, y);
+    
+    // number of non-empty columns within [x - ox, x + ox]
+    int columns = 0;
+    for (int i = 0; i < ox && i < tx1 - tx0; i++)
+      columns += count[i] != 0;
+    
+    for (int i = 0; i < tx1 - tx0; i++) {
+      if (i + ox < tx1 - tx0) columns += count[i + ox] != 0;
+      if (i - ox - 1 >= 0) columns -= count[i - ox - 1] != 0;
+      
+      if (columns && bitmap_row_get(&row, tx0 + i) != orig)
+        bitmap_row_set(&row, tx0 + i, draw);
     }
-
+  }
+  
+  free(count);
   graphics_release_frame_buffer(ctx, fb);
-}
\ No newline at end of file
+}
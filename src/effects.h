@@ -7,7 +7,55 @@ typedef struct {
    uint8_t *bitmap_data;
    int bytes_per_row;
    GBitmapFormat bitmap_format;
+   GRect bounds; // bitmap bounds, used to clip rows and columns
 }  BitmapInfo;
+
+// row cursor over BitmapInfo - resolves pixel format and valid row range once per row instead of once per pixel
+typedef struct {
+  BitmapInfo *info; // bitmap the cursor walks
+  uint8_t *data;    // data of the current row (pixel x is at data[x] or in bit x of data)
+  int16_t y;        // current row
+  int16_t min_x;    // first valid pixel of the row
+  int16_t max_x;    // last valid pixel of the row (less than min_x if the row is outside of the bitmap)
+  bool one_bit;     // row is 1 bit per pixel
+} BitmapRow;
+
+// fills bitmap info for given bitmap
+void bitmap_info_init(BitmapInfo *bitmap_info, GBitmap *bitmap);
+
+// positions cursor at the beginning of row y
+void bitmap_row_begin(BitmapRow *row, BitmapInfo *bitmap_info, int y);
+
+// advances cursor to the next row
+void bitmap_row_next(BitmapRow *row);
+
+// get pixel color at given column of the cursor row (-1 if outside of the row)
+static inline uint8_t bitmap_row_get(const BitmapRow *row, int x) {
+  if (x < row->min_x || x > row->max_x) return -1;
+#ifndef PBL_PLATFORM_APLITE
+  if (row->one_bit) return (row->data[x / 8] << (x % 8)) & 128; // 1bit palette on Basalt - shifting left to get correct bit
+#else
+  if (row->one_bit) return (row->data[x / 8] >> (x % 8)) & 1; // 1 bit on Aplite - shifting right to get bit
+#endif
+  return row->data[x];
+}
+
+// set pixel color at given column of the cursor row (ignored if outside of the row)
+static inline void bitmap_row_set(BitmapRow *row, int x, uint8_t color) {
+  if (x < row->min_x || x > row->max_x) return;
+  if (row->one_bit)
+    row->data[x / 8] ^= (-color ^ row->data[x / 8]) & (1 << (x % 8));
+  else
+    row->data[x] = color;
+}
+
+// milliseconds since epoch wrapped to 32 bits, good enough for measuring intervals (frame stats, effect layer profiler)
+static inline uint32_t clock_ms(void) {
+  time_t t;
+  uint16_t ms;
+  time_ms(&t, &ms);
+  return (uint32_t)t * 1000 + ms;
+}
   
 // structure of mask for masking effects
 typedef struct {
@@ -28,6 +76,22 @@ typedef struct {
   uint32_t  frame; // frame number
 } EffectFPS;  
 
+#define FRAME_STATS_BUCKETS 16 // histogram buckets, bucket b holds times of [2^b, 2^(b+1)) ms
+#define FRAME_STATS_LAST 8 // number of last frame times shown
+
+// structure for frame statistics effect (zero initialized or cleared by effect_frame_stats_reset)
+typedef struct {
+  uint16_t  frame_hist[FRAME_STATS_BUCKETS]; // histogram of times between frames
+  uint16_t  render_hist[FRAME_STATS_BUCKETS]; // histogram of render times (from effect_frame_stats_mark)
+  uint16_t  last[FRAME_STATS_LAST]; // last times between frames, ring buffer
+  uint8_t   next_last;
+  uint16_t  frame_min, frame_max; // ms
+  uint16_t  render_min, render_max; // ms
+  uint32_t  frames, renders; // number of measured frames and renders
+  uint32_t  prev_frame; // time of previous frame (ms, 0 before the first one)
+  uint32_t  render_start; // time render of current frame started (ms, 0 if not marked)
+} EffectFrameStats;
+
 // structure for effect at given offset (currently used for effect_shadow)
 typedef struct {
   GColor orig_color; //color of pixel being ofset
@@ -35,7 +99,6 @@ typedef struct {
   int8_t offset_x; // horizontal ofset
   int8_t offset_y; // vertical offset
   int8_t option; // optional parameter (currently in effect_shadow 1=draw long shadow)
-  uint8_t *aplite_visited; // for Applite holds array of visited pixels
 } EffectOffset;  
 
 // structure for color swap effect
@@ -46,10 +109,21 @@ typedef struct {
 
 typedef void effect_cb(GContext* ctx, GRect position, void* param);
 
+// builds 256 entry lut of a per-pixel effect (invert, lut, colorize, colorswap, invert_bw_only, invert_brightness)
+// returns false if effect can't be expressed as a lut
+bool effect_get_lut(effect_cb *effect, void *param, uint8_t *lut);
+
+// applies lut to given area of already captured bitmap
+void effect_lut_apply(BitmapInfo *bitmap_info, GRect position, const uint8_t *lut);
+
 // inverter effect.
 // Added by Yuriy Galanter
 effect_cb effect_invert;
 
+// LUT effect - maps every pixel thru a precomputed table in a single pass
+// Parameter: const uint8_t[256] table indexed by pixel color (on 1-bit framebuffers only entries 0 and 1 are used)
+effect_cb effect_lut;
+
 // colorize effect.
 // Added by Martin Norland (@cynorg)
 effect_cb effect_colorize;
@@ -75,12 +149,13 @@ effect_cb effect_mirror_horizontal;
 
 // Rotate 90 degrees
 // Added by Ron64
-// Parameter: true: rotate right/clockwise false: rotate left/counter_clockwise
+// Parameter: true: rotate right/clockwise false: rotate left/counter_clockwise, 2: rotate 180 degrees
 effect_cb effect_rotate_90_degrees;
 
 // blur effect.
 // Added by Grégoire Sage
-// Parameter: blur radius
+// Parameter: blur radius, up to BLUR_MAX_RADIUS (larger values are clamped)
+#define BLUR_MAX_RADIUS 170
 effect_cb effect_blur;
 
 // Zoom effect
@@ -96,6 +171,10 @@ effect_cb effect_zoom;
 // Parameters: lens focal(high byte) and object distance(low byte)
 effect_cb effect_lens;
 
+// frees the displacement table cached by effect_lens (the next lens call rebuilds it),
+// effect layers call it when their last lens effect is gone
+void effect_lens_release(void);
+
 #define EL_LENS(f,d) ((void*) ( d|(f<<8)))
 
 
@@ -108,9 +187,22 @@ effect_cb effect_mask;
 // Probably works better on a fullscreen effect layer so it can catch all redraw messages
 effect_cb effect_fps;
 
+// Frame statistics: displays min/p50/p95/max of time between frames (F) and of render time (R) in ms, followed by
+// the last FRAME_STATS_LAST frame times. Render time is measured from effect_frame_stats_mark, which should run on
+// an effect layer below everything else. Both take EffectFrameStats as a parameter.
+// Percentiles come from power of two histogram buckets, so they are upper bounds of the bucket.
+effect_cb effect_frame_stats;
+effect_cb effect_frame_stats_mark;
+
+// clears frame statistics (e.g. after configuration change)
+void effect_frame_stats_reset(EffectFrameStats *stats);
+
 // shadow effect
 // Added by Yuriy Galanter
 // uses EffecOffset as a parameter;
 effect_cb effect_shadow;
 
+// outline effect
+// paints offset_color on pixels within offset_x/offset_y of orig_color pixels of the layer
+// uses EffecOffset as a parameter;
 effect_cb effect_outline;
\ No newline at end of file
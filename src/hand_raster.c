@@ -0,0 +1,214 @@
+#include <pebble.h>
+#include "hand_raster.h"
+#include "math.h"
+
+// edge of a polygon going down (y0 <= y1), x is stepped one row at a time
+typedef struct {
+  int32_t x;      // Q16 x on the current row
+  int32_t dx;     // Q16 x step per row
+  int16_t y0, y1; // first and last row of the edge
+  int16_t xa, xb; // x at y0 and at y1
+} RasterEdge;
+
+typedef struct {
+  RasterEdge edges[HAND_RASTER_MAX_POINTS];
+  uint8_t num_edges;
+  uint8_t color;  // pixel value in framebuffer format
+  bool fill_only; // no outline spans
+  int16_t y0, y1; // rows covered by the polygon
+} RasterPolygon;
+
+// span of pixels [x0, x1)
+typedef struct {
+  int16_t x0, x1;
+} RasterSpan;
+
+#define RASTER_MAX_SPANS (HAND_RASTER_MAX_POINTS * 2) // every edge and every pair of crossings
+
+#define FX_ROUND(v) (((v) + FX_ONE / 2) >> 16)
+#define FX_CEIL(v) (((v) + FX_ONE - 1) >> 16)
+#define FX_FLOOR(v) ((v) >> 16)
+
+static void edge_init(RasterEdge *edge, int xa, int ya, int xb, int yb) {
+  if (ya > yb) {
+    int t = xa; xa = xb; xb = t;
+    t = ya; ya = yb; yb = t;
+  }
+  edge->y0 = ya;
+  edge->y1 = yb;
+  edge->xa = xa;
+  edge->xb = xb;
+  edge->x = xa * FX_ONE;
+  edge->dx = ya == yb ? 0 : (xb - xa) * FX_ONE / (yb - ya);
+}
+
+static void polygon_init(RasterPolygon *poly, const HandPolygon *hand, GPoint center, bool one_bit) {
+  uint8_t n = hand->num_points < HAND_RASTER_MAX_POINTS ? hand->num_points : HAND_RASTER_MAX_POINTS;
+
+  poly->num_edges = n;
+  poly->fill_only = hand->fill_only;
+  poly->y0 = INT16_MAX;
+  poly->y1 = INT16_MIN;
+  for (uint8_t i = 0; i < n; i++) {
+    const int8_t *a = hand->points[i], *b = hand->points[(i + 1) % n];
+    edge_init(&poly->edges[i], center.x + a[0], center.y + a[1], center.x + b[0], center.y + b[1]);
+    if (poly->edges[i].y0 < poly->y0) poly->y0 = poly->edges[i].y0;
+    if (poly->edges[i].y1 > poly->y1) poly->y1 = poly->edges[i].y1;
+  }
+
+  if (one_bit)
+    poly->color = gcolor_equal(hand->color, GColorWhite) ? 1 : 0;
+  else
+    poly->color = hand->color.argb;
+}
+
+// pixels of a 1 pixel wide line along the edge on row y: one per row on steep edges, on shallow ones the run
+// from half a row above to half a row below the pixel center (vertices included)
+static void edge_row_span(const RasterEdge *edge, int y, RasterSpan *span) {
+  int x0, x1;
+  if (edge->y0 == edge->y1) {
+    x0 = edge->xa < edge->xb ? edge->xa : edge->xb;
+    x1 = (edge->xa < edge->xb ? edge->xb : edge->xa) + 1;
+  } else if (edge->dx >= -FX_ONE && edge->dx <= FX_ONE) {
+    x0 = FX_ROUND(edge->x);
+    x1 = x0 + 1;
+  } else {
+    int32_t lo = y == edge->y0 ? edge->xa * FX_ONE : edge->x - edge->dx / 2;
+    int32_t hi = y == edge->y1 ? edge->xb * FX_ONE : edge->x + edge->dx / 2;
+    bool lo_vertex = y == edge->y0, hi_vertex = y == edge->y1;
+    if (lo > hi) {
+      int32_t t = lo; lo = hi; hi = t;
+      bool v = lo_vertex; lo_vertex = hi_vertex; hi_vertex = v;
+    }
+    x0 = lo_vertex ? FX_ROUND(lo) : FX_CEIL(lo - FX_ONE / 2);
+    x1 = hi_vertex ? FX_ROUND(hi) + 1 : FX_CEIL(hi - FX_ONE / 2);
+    if (x1 <= x0) x1 = x0 + 1;
+  }
+  span->x0 = x0;
+  span->x1 = x1;
+}
+
+// collects spans of the polygon on row y: pixels crossed by the edges (the outline, unless fill_only) and pixel
+// centers between pairs of edge crossings (the fill, even-odd). Steps the edges to the next row.
+static uint8_t polygon_row_spans(RasterPolygon *poly, int y, RasterSpan *spans) {
+  int32_t cross[HAND_RASTER_MAX_POINTS];
+  uint8_t num_cross = 0, num_spans = 0;
+
+  for (uint8_t i = 0; i < poly->num_edges; i++) {
+    RasterEdge *edge = &poly->edges[i];
+    if (y < edge->y0 || y > edge->y1) continue;
+
+    if (!poly->fill_only) edge_row_span(edge, y, &spans[num_spans++]);
+
+    // half open so vertices shared by two edges cross once
+    if (y < edge->y1) {
+      int j = num_cross++;
+      for (; j > 0 && cross[j - 1] > edge->x; j--) cross[j] = cross[j - 1];
+      cross[j] = edge->x;
+    }
+    edge->x += edge->dx;
+  }
+
+  for (uint8_t i = 0; i + 1 < num_cross; i += 2) {
+    int x0 = FX_CEIL(cross[i]), x1 = FX_FLOOR(cross[i + 1]) + 1;
+    if (x0 < x1) {
+      spans[num_spans].x0 = x0;
+      spans[num_spans].x1 = x1;
+      num_spans++;
+    }
+  }
+
+  return num_spans;
+}
+
+// sorts spans and joins overlapping or touching ones, returns the new count
+static uint8_t spans_merge(RasterSpan *spans, uint8_t count) {
+  for (uint8_t i = 1; i < count; i++) {
+    RasterSpan s = spans[i];
+    int j = i;
+    for (; j > 0 && spans[j - 1].x0 > s.x0; j--) spans[j] = spans[j - 1];
+    spans[j] = s;
+  }
+
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    if (n > 0 && spans[i].x0 <= spans[n - 1].x1) {
+      if (spans[i].x1 > spans[n - 1].x1) spans[n - 1].x1 = spans[i].x1;
+    } else {
+      spans[n++] = spans[i];
+    }
+  }
+  return n;
+}
+
+// sets pixels [x0, x1) of the row to color, whole bytes at a time on 1-bit rows
+static void row_fill_span(BitmapRow *row, int x0, int x1, uint8_t color) {
+  if (x0 < row->min_x) x0 = row->min_x;
+  if (x1 > row->max_x + 1) x1 = row->max_x + 1;
+  if (x0 >= x1) return;
+
+  if (!row->one_bit) {
+    memset(row->data + x0, color, x1 - x0);
+    return;
+  }
+
+#ifdef PBL_PLATFORM_APLITE
+  // LSB is the leftmost pixel
+  uint8_t *p = row->data + (x0 >> 3);
+  uint8_t *end = row->data + (x1 >> 3);
+  uint8_t head = 0xFF << (x0 & 7);
+  uint8_t tail = (1 << (x1 & 7)) - 1;
+  uint8_t fill = color ? 0xFF : 0x00;
+
+  if (p == end) {
+    *p = (*p & ~(head & tail)) | (fill & head & tail);
+    return;
+  }
+  *p = (*p & ~head) | (fill & head);
+  p++;
+  memset(p, fill, end - p);
+  if (tail) *end = (*end & ~tail) | (fill & tail);
+#else
+  for (int x = x0; x < x1; x++) bitmap_row_set(row, x, color);
+#endif
+}
+
+void hand_raster_draw(GContext *ctx, GRect clip, GPoint center, const HandPolygon *polygons, uint8_t count) {
+  GBitmap *fb = graphics_capture_frame_buffer(ctx);
+  if (!fb) return;
+
+  BitmapInfo bitmap_info;
+  bitmap_info_init(&bitmap_info, fb);
+  BitmapRow row;
+  bitmap_row_begin(&row, &bitmap_info, 0);
+
+  RasterPolygon polys[HAND_RASTER_MAX_POLYGONS];
+  if (count > HAND_RASTER_MAX_POLYGONS) count = HAND_RASTER_MAX_POLYGONS;
+  int y0 = INT16_MAX, y1 = INT16_MIN;
+  for (uint8_t i = 0; i < count; i++) {
+    polygon_init(&polys[i], &polygons[i], center, row.one_bit);
+    if (polys[i].y0 < y0) y0 = polys[i].y0;
+    if (polys[i].y1 > y1) y1 = polys[i].y1;
+  }
+
+  // rows before the clip still step the edges
+  int clip_x0 = clip.origin.x, clip_x1 = clip.origin.x + clip.size.w;
+  int clip_y0 = clip.origin.y, clip_y1 = clip.origin.y + clip.size.h;
+  if (y1 >= clip_y1) y1 = clip_y1 - 1;
+
+  RasterSpan spans[RASTER_MAX_SPANS];
+  for (bitmap_row_begin(&row, &bitmap_info, y0); row.y <= y1; bitmap_row_next(&row)) {
+    for (uint8_t i = 0; i < count; i++) {
+      if (row.y < polys[i].y0 || row.y > polys[i].y1) continue;
+
+      uint8_t n = polygon_row_spans(&polys[i], row.y, spans);
+      if (row.y < clip_y0) continue;
+
+      n = spans_merge(spans, n);
+      for (uint8_t s = 0; s < n; s++)
+        row_fill_span(&row, spans[s].x0 > clip_x0 ? spans[s].x0 : clip_x0, spans[s].x1 < clip_x1 ? spans[s].x1 : clip_x1, polys[i].color);
+    }
+  }
+
+  graphics_release_frame_buffer(ctx, fb);
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <pebble.h>
+#include "effects.h"
+
+#define HAND_RASTER_MAX_POLYGONS 4 // polygons drawn in one pass (bodies and insets of two hands)
+#define HAND_RASTER_MAX_POINTS 8 // vertices of one polygon
+
+// polygon of a hand, vertices are {x, y} relative to the hand center
+typedef struct {
+  const int8_t (*points)[2];
+  uint8_t num_points;
+  GColor color; // fill of the polygon including its edges (as gpath_draw_filled + gpath_draw_outline in the same color)
+  bool fill_only; // interior only, without the edges (as gpath_draw_filled alone)
+} HandPolygon;
+
+// Draws polygons straight into the framebuffer in one top-down pass, later polygons over earlier ones.
+// Edges are stepped in 16.16 fixed point, on every row all spans of a polygon are merged so each pixel is written
+// once per polygon. center and clip are in framebuffer (window) coordinates.
+void hand_raster_draw(GContext *ctx, GRect clip, GPoint center, const HandPolygon *polygons, uint8_t count);
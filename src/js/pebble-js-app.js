@@ -1,11 +1,68 @@
 var initialised = false;
 
-function appMessageAck(e) {
-    console.log("options sent to Pebble successfully");
+// Options are sent as one byte array {version, mask, values...}, mask bit n = value n present.
+// Every message is a full snapshot (all mask bits set), the watch skips values it already has.
+// NACKed messages are retried.
+var MSG_VERSION = 1;
+var MSG_FIELDS = ["inv", "anim", "sep", "vibr", "showsec", "datefmt"];
+var MSG_MASK_ALL = (1 << MSG_FIELDS.length) - 1;
+var MSG_RETRY_MS = 1000;
+var MSG_RETRY_MAX = 5;
+
+var pending = null, sending = false, retries = 0, retryTimer = null;
+
+var SHOWSEC_VALUES = {"nev": 0, "05s": 5, "10s": 10, "15s": 15, "30s": 30};
+var DATEFMT_VALUES = {"fra": 1, "eng": 2, "usa": 3};
+
+function encodeOption(name, value) {
+    switch (name) {
+        case "showsec":
+            return SHOWSEC_VALUES.hasOwnProperty(value) ? SHOWSEC_VALUES[value] : 1;
+        case "datefmt":
+            return DATEFMT_VALUES.hasOwnProperty(value) ? DATEFMT_VALUES[value] : 0;
+        default:
+            return value === "yes" ? 1 : 0;
+    }
 }
 
-function appMessageNack(e) {
-    console.log("options not sent to Pebble: " + e.error.message);
+function encodeOptions(options) {
+    return MSG_FIELDS.map(function(name) {
+        return encodeOption(name, options[name]);
+    });
+}
+
+function sendOptions() {
+    if (!pending || sending) {
+        return;
+    }
+
+    var values = pending;
+    sending = true;
+    Pebble.sendAppMessage({"cfg": [MSG_VERSION, MSG_MASK_ALL].concat(values)},
+        function(e) {
+            console.log("options sent to Pebble successfully");
+            sending = false;
+            retries = 0;
+            if (pending === values) {
+                pending = null;
+            }
+            sendOptions();
+        },
+        function(e) {
+            console.log("options not sent to Pebble: " + e.error.message);
+            sending = false;
+            if (retries < MSG_RETRY_MAX) {
+                retryTimer = setTimeout(function() {
+                    retryTimer = null;
+                    sendOptions();
+                }, MSG_RETRY_MS << retries);
+                retries++;
+            } else {
+                console.log("giving up sending options");
+                pending = null;
+                retries = 0;
+            }
+        });
 }
 
 Pebble.addEventListener("ready", function() {
@@ -36,7 +93,14 @@ Pebble.addEventListener("webviewclosed", function(e) {
         var options = JSON.parse(decodeURIComponent(e.response));
         console.log("storing options: " + JSON.stringify(options));
         localStorage.setItem('nadir_opt', JSON.stringify(options));
-        Pebble.sendAppMessage(options, appMessageAck, appMessageNack);
+        pending = encodeOptions(options);
+        // a new config restarts the backoff instead of waiting for the old retry
+        if (retryTimer !== null) {
+            clearTimeout(retryTimer);
+            retryTimer = null;
+        }
+        retries = 0;
+        sendOptions();
     } else {
         console.log("no options received");
     }
@@ -1,7 +1,16 @@
 #include <pebble.h>
 #include "effect_layer.h"
+#include "hand_raster.h"
+#include "src/hand_tables.auto.h" //Hand shapes at every position, generated at build time by tools/gen_hands.py
 
-#define TIMER_MS 100
+//#define NADIR_FRAME_STATS //Overlay with frame time statistics, for development
+
+//Battery sheet: 11 battery cells (0 = full ... 10 = charging), then the radio icon
+#define BATT_SPRITES 12
+#define BATT_SPRITE_RADIO 11
+
+//Heap left free by the background cache, theme changes reload the face and battery bitmaps
+#define CACHE_HEAP_RESERVE 4096
 
 enum ConfigKeys {
 	CONFIG_KEY_INV=1,
@@ -9,10 +18,31 @@ enum ConfigKeys {
 	CONFIG_KEY_SEP=3,
 	CONFIG_KEY_DATEFMT=4,
 	CONFIG_KEY_VIBR=5,
-	CONFIG_KEY_SHOWSEC=6
+	CONFIG_KEY_SHOWSEC=6,
+	CONFIG_KEY_MSG=7,
+	CONFIG_KEY_DATA=10
+};
+
+//Settings message from the phone: one byte array {version, mask, values...},
+//the phone always sends the full snapshot of all values (mask 0x3F); bit n of mask
+//tells that value n is present, so a value left out keeps its current setting
+#define CONFIG_MSG_VERSION 1
+enum ConfigMsgFields {
+	CONFIG_MSG_INV,
+	CONFIG_MSG_ANIM,
+	CONFIG_MSG_SEP,
+	CONFIG_MSG_VIBR,
+	CONFIG_MSG_SHOWSEC,
+	CONFIG_MSG_DATEFMT,
+	CONFIG_MSG_COUNT
 };
+#define CONFIG_MSG_SIZE (2 + CONFIG_MSG_COUNT)
+
+//Bump when CfgDta_t changes, older blobs are then ignored and defaults used
+#define CONFIG_VERSION 1
 
 typedef struct {
+	uint8_t version;
 	bool inv;
 	bool anim;
 	bool sep;
@@ -21,31 +51,6 @@ typedef struct {
 	uint16_t datefmt;
 } CfgDta_t;
 
-static const struct GPathInfo HOUR_PATH_INFO = {
- 	.num_points = 7, 
-	.points = (GPoint[]) {{0, 0}, {-6, -11}, {-2, -16}, {-2, -33}, {2, -33}, {2, -16}, {6, -11}}
-};
-static const struct GPathInfo HOUR2_PATH_INFO = {
- 	.num_points = 5, 
-	.points = (GPoint[]) {{0, -2}, {-4, -11}, {-2, -14}, {2, -14}, {4, -11}}
-};
-
-static const struct GPathInfo MINS_PATH_INFO = {
- 	.num_points = 7, 
-	.points = (GPoint[]) {{0, 0}, {-5, -11}, {-2, -15}, {-2, -38}, {2, -38}, {2, -15}, {5, -11}}
-};
-static const struct GPathInfo MINS2_PATH_INFO = {
- 	.num_points = 5, 
-	.points = (GPoint[]) {{0, -2}, {-3, -11}, {-1, -13}, {1, -13}, {3, -11}}
-};
-
-static const struct GPathInfo SECS_PATH_INFO = {
- 	.num_points = 7, 
-	.points = (GPoint[]) {{0, 0}, {-4, -11}, {-2, -13}, {-2, -38}, {2, -38}, {2, -13}, {4, -11}}
-};
-
-GPath *hour_path, *mins_path, *secs_path, *hour2_path, *mins2_path;
-
 static const uint32_t segments[] = {100, 100, 100};
 static const VibePattern vibe_pat = {
 	.durations = segments,
@@ -53,63 +58,168 @@ static const VibePattern vibe_pat = {
 };
 
 Window *window;
-Layer *hands_layer, *secs_layer;
+Layer *hands_layer, *secs_layer, *bg_layer, *capture_layer;
 TextLayer* date_layer;
-InverterLayer* inv_layer;
 BitmapLayer *radio_layer, *battery_layer, *face_layer;
 static PropertyAnimation *s_prop_anim_bt, *s_prop_anim_batt;
+static Animation *s_intro_anim;
 
 static GFont digitS;
 char hhBuffer[] = "00";
 char ddmmyyyyBuffer[] = "00:00 00.00.";
 static GBitmap *bmp_face, *batteryAll;
-static int16_t aktHH, aktMM, aktSS, step;
-static AppTimer *timer;
+static GBitmap *batt_sprites[BATT_SPRITES];
+static int8_t batt_index = -1, batt_inv = -1, face_inv = -1;
+static int16_t aktHH, aktMM, aktSS, anim_HH, anim_MM, anim_SS;
+static AppTimer *secs_timer;
 static bool b_initialized;
 static CfgDta_t CfgData;
+static uint8_t *cache_data;
+static bool b_cache_valid, b_cache_used;
+static bool b_secs_only;
+static GRect secs_dirty;
+#ifdef NADIR_FRAME_STATS
+static EffectLayer *stats_layer, *stats_mark_layer;
+static EffectFrameStats frame_stats;
+#endif
 
+//-----------------------------------------------------------------------------------------------------------------------
+// Inverted theme draws with swapped colors instead of inverting the finished frame
+static GColor theme_color(GColor color)
+{
+	if (CfgData.inv)
+		color.argb ^= 0x3F;
+	return color;
+}
+//-----------------------------------------------------------------------------------------------------------------------
+// Background cache: face, hands and date change once a minute, so after they are drawn the framebuffer is copied
+// into cache_data (capture_layer) and second ticks hide them and just copy it back (bg_layer).
+// Rows are stored one after another, each only with its valid bytes (round display rows are shorter).
+// Only rows and bytes within rc are copied.
+// The whole frame is kept because any redraw the system triggers (e.g. after a notification) must be restored too.
+// That is 3024 bytes on Aplite (1-bit), 24192 on Basalt and about 25 KB on Chalk, out of 24 KB / 64 KB of app
+// memory. It is only allocated if CACHE_HEAP_RESERVE bytes stay free, otherwise every frame draws all layers.
+static void cache_copy(GContext *ctx, bool to_cache, GRect rc)
+{
+	GBitmap *fb = graphics_capture_frame_buffer(ctx);
+	if (!fb)
+		return;
+	
+	BitmapInfo bitmap_info;
+	bitmap_info_init(&bitmap_info, fb);
+	BitmapRow row;
+	
+	if (!cache_data)
+	{
+		int size = 0;
+		for (bitmap_row_begin(&row, &bitmap_info, bitmap_info.bounds.origin.y); row.y < bitmap_info.bounds.origin.y + bitmap_info.bounds.size.h; bitmap_row_next(&row))
+			size += row.one_bit ? row.max_x/8 - row.min_x/8 + 1 : row.max_x - row.min_x + 1;
+		if (heap_bytes_free() < (size_t)size + CACHE_HEAP_RESERVE)
+		{
+			app_log(APP_LOG_LEVEL_WARNING, __FILE__, __LINE__, "No heap for background cache (%d bytes)", size);
+			graphics_release_frame_buffer(ctx, fb);
+			return;
+		}
+		cache_data = malloc(size);
+	}
+	
+	if (cache_data)
+	{
+		uint8_t *p = cache_data;
+		for (bitmap_row_begin(&row, &bitmap_info, bitmap_info.bounds.origin.y); row.y < bitmap_info.bounds.origin.y + bitmap_info.bounds.size.h; bitmap_row_next(&row))
+		{
+			int first = row.one_bit ? row.min_x/8 : row.min_x;
+			int len = row.one_bit ? row.max_x/8 - row.min_x/8 + 1 : row.max_x - row.min_x + 1;
+			
+			//Clip to rc
+			int start = row.one_bit ? rc.origin.x/8 : rc.origin.x;
+			int end = row.one_bit ? (rc.origin.x + rc.size.w + 7)/8 : rc.origin.x + rc.size.w;
+			if (start < first)
+				start = first;
+			if (end > first + len)
+				end = first + len;
+			
+			if (row.y >= rc.origin.y && row.y < rc.origin.y + rc.size.h && start < end)
+			{
+				if (to_cache)
+					memcpy(p + start - first, row.data + start, end - start);
+				else
+					memcpy(row.data + start, p + start - first, end - start);
+			}
+			p += len;
+		}
+	}
+	
+	graphics_release_frame_buffer(ctx, fb);
+}
+//-----------------------------------------------------------------------------------------------------------------------
+// Window background is clear, so the framebuffer keeps the previous frame. On frames changing only the second hand
+// just the dirty rect is restored, otherwise the whole background.
+static void bg_update_proc(Layer *layer, GContext *ctx) 
+{
+	GRect bounds = layer_get_bounds(layer);
+	
+	if (b_cache_used && b_secs_only)
+		cache_copy(ctx, false, secs_dirty);
+	else if (b_cache_used)
+		cache_copy(ctx, false, bounds);
+	else
+	{
+		graphics_context_set_fill_color(ctx, theme_color(GColorBlack));
+		graphics_fill_rect(ctx, bounds, 0, GCornerNone);
+	}
+	b_secs_only = false;
+}
+//-----------------------------------------------------------------------------------------------------------------------
+static void capture_update_proc(Layer *layer, GContext *ctx) 
+{
+	//Hands are moving during startup animation
+	if (!b_initialized || b_cache_valid)
+		return;
+	
+	cache_copy(ctx, true, layer_get_bounds(layer));
+	b_cache_valid = cache_data != NULL;
+}
+//-----------------------------------------------------------------------------------------------------------------------
+static void cache_set_used(bool used)
+{
+	b_cache_used = used;
+	layer_set_hidden(bitmap_layer_get_layer(face_layer), used);
+	layer_set_hidden(hands_layer, used);
+	layer_set_hidden(text_layer_get_layer(date_layer), used);
+}
+//-----------------------------------------------------------------------------------------------------------------------
+static void cache_invalidate(void)
+{
+	b_secs_only = false;
+	b_cache_valid = false;
+	if (b_cache_used)
+		cache_set_used(false);
+}
 //-----------------------------------------------------------------------------------------------------------------------
 static void hands_update_proc(Layer *layer, GContext *ctx) 
 {
 	GRect bounds = layer_get_bounds(layer);
-	GPoint center = grect_center_point(&bounds), ptLin;
-	graphics_context_set_stroke_color(ctx, GColorWhite);
-	
-	//Draw Hour Path
-	int32_t angle = (TRIG_MAX_ANGLE * (((aktHH % 12) * 6) + (aktMM / 10))) / (12 * 6), sinl = sin_lookup(angle), cosl = cos_lookup(angle), rad = 36;
-	ptLin.x = (int16_t)(sinl * (int32_t)(rad) / TRIG_MAX_RATIO) + center.x;
-	ptLin.y = (int16_t)(-cosl * (int32_t)(rad) / TRIG_MAX_RATIO) + center.y;
-	
-	graphics_context_set_fill_color(ctx, GColorWhite);
-	gpath_move_to(hour_path, ptLin);
-	gpath_rotate_to(hour_path, angle);
-	gpath_draw_filled(ctx, hour_path);
-	gpath_draw_outline(ctx, hour_path);
-	graphics_context_set_fill_color(ctx, COLOR_FALLBACK(GColorBlue, GColorBlack));
-	gpath_move_to(hour2_path, ptLin);
-	gpath_rotate_to(hour2_path, angle);
-	gpath_draw_filled(ctx, hour2_path);
-
-	//Draw Minute Path
-	angle = TRIG_MAX_ANGLE * aktMM / 60; sinl = sin_lookup(angle); cosl = cos_lookup(angle);
-	ptLin.x = (int16_t)(sinl * (int32_t)(rad) / TRIG_MAX_RATIO) + center.x;
-	ptLin.y = (int16_t)(-cosl * (int32_t)(rad) / TRIG_MAX_RATIO) + center.y;
-	
-	graphics_context_set_fill_color(ctx, GColorWhite);
-	gpath_move_to(mins_path, ptLin);
-	gpath_rotate_to(mins_path, angle);
-	gpath_draw_filled(ctx, mins_path);
-	gpath_draw_outline(ctx, mins_path);
-	graphics_context_set_fill_color(ctx, COLOR_FALLBACK(GColorGreen, GColorBlack));
-	gpath_move_to(mins2_path, ptLin);
-	gpath_rotate_to(mins2_path, angle);
-	gpath_draw_filled(ctx, mins2_path);
+	graphics_context_set_stroke_color(ctx, theme_color(GColorWhite));
+	
+	//Draw Hour and Minute hands, bodies with their insets (fill only), minutes over hours
+	int16_t pos = (aktHH % 12) * 6 + aktMM / 10;
+	GRect frame = layer_get_frame(layer);
+	HandPolygon hands[] = {
+		{ HOUR_HAND[pos], HOUR_HAND_POINTS, theme_color(GColorWhite), false },
+		{ HOUR2_HAND[pos], HOUR2_HAND_POINTS, theme_color(COLOR_FALLBACK(GColorBlue, GColorBlack)), true },
+		{ MINS_HAND[aktMM], MINS_HAND_POINTS, theme_color(GColorWhite), false },
+		{ MINS2_HAND[aktMM], MINS2_HAND_POINTS, theme_color(COLOR_FALLBACK(GColorGreen, GColorBlack)), true },
+	};
+	hand_raster_draw(ctx, frame, grect_center_point(&frame), hands, ARRAY_LENGTH(hands));
 
 #if defined(PBL_RECT)
 	if (CfgData.sep)
 		graphics_draw_line(ctx, GPoint(10, bounds.size.h-1), GPoint(bounds.size.w-10, bounds.size.h-1));
 #elif defined(PBL_ROUND)
-	graphics_context_set_fill_color(ctx, GColorBlack);
+	GPoint center = grect_center_point(&bounds);
+	graphics_context_set_fill_color(ctx, theme_color(GColorBlack));
+	graphics_context_set_text_color(ctx, theme_color(GColorWhite));
 
 	//Radio & Battery
 	graphics_fill_radial(ctx, GRect(-20, center.y-20, 40, 40), GOvalScaleModeFitCircle, 20, DEG_TO_TRIGANGLE(10), DEG_TO_TRIGANGLE(170));
@@ -131,21 +241,26 @@ static void hands_update_proc(Layer *layer, GContext *ctx)
 //-----------------------------------------------------------------------------------------------------------------------
 static void secs_update_proc(Layer *layer, GContext *ctx) 
 {
-	GRect bounds = layer_get_bounds(layer);
-	GPoint center = grect_center_point(&bounds), ptLin;
-	graphics_context_set_stroke_color(ctx, GColorWhite);
-	
-	//Draw Second Path
-	int32_t angle = TRIG_MAX_ANGLE * aktSS / 60, sinl = sin_lookup(angle), cosl = cos_lookup(angle), rad = 36;
-	ptLin.x = (int16_t)(sinl * (int32_t)(rad-14) / TRIG_MAX_RATIO) + center.x;
-	ptLin.y = (int16_t)(-cosl * (int32_t)(rad-14) / TRIG_MAX_RATIO) + center.y;
-	
-	graphics_context_set_fill_color(ctx, GColorWhite);
-	gpath_move_to(secs_path, ptLin);
-	angle = TRIG_MAX_ANGLE * ((aktSS+30)%60) / 60;
-	gpath_rotate_to(secs_path, angle);
-	gpath_draw_outline(ctx, secs_path);
-	gpath_draw_filled(ctx, secs_path);
+	GRect frame = layer_get_frame(layer);
+	
+	//Draw Second hand
+	HandPolygon secs = { SECS_HAND[aktSS], SECS_HAND_POINTS, theme_color(GColorWhite), false };
+	hand_raster_draw(ctx, frame, grect_center_point(&frame), &secs, 1);
+}
+//-----------------------------------------------------------------------------------------------------------------------
+// Bounding box of the second hand at given second in window coordinates, x aligned to bytes of 1-bit framebuffer
+static GRect secs_hand_rect(int16_t ss)
+{
+	GRect frame = layer_get_frame(secs_layer);
+	GPoint center = grect_center_point(&frame);
+	const int8_t *box = SECS_HAND_BOX[ss];
+	
+	//Margin for outline and rounding
+	int16_t x0 = (center.x + box[0] - 2) & ~7;
+	int16_t x1 = (center.x + box[2] + 3 + 7) & ~7;
+	int16_t y0 = center.y + box[1] - 2;
+	int16_t y1 = center.y + box[3] + 3;
+	return GRect(x0, y0, x1 - x0, y1 - y0);
 }
 //-----------------------------------------------------------------------------------------------------------------------
 static void handle_tick(struct tm *tick_time, TimeUnits units_changed) 
@@ -153,6 +268,8 @@ static void handle_tick(struct tm *tick_time, TimeUnits units_changed)
 	//Update Date
 	if (tick_time->tm_sec == 0 || units_changed == MINUTE_UNIT)
 	{
+		cache_invalidate();
+		
 #if defined(PBL_RECT)
 		if(clock_is_24h_style())
 			strftime(ddmmyyyyBuffer, sizeof(ddmmyyyyBuffer), 
@@ -188,7 +305,23 @@ static void handle_tick(struct tm *tick_time, TimeUnits units_changed)
 		}
 		else if (CfgData.showsec != 0 && (tick_time->tm_sec % CfgData.showsec) == 0) 
 		{
+			GRect rc_old = secs_hand_rect(aktSS);
 			aktSS = tick_time->tm_sec;
+			if (b_cache_valid && !b_cache_used)
+				cache_set_used(true);
+#ifndef NADIR_FRAME_STATS
+			else if (b_cache_used)
+			{
+				//Only the second hand changes - old and new position
+				GRect rc_new = secs_hand_rect(aktSS);
+				int16_t x0 = rc_old.origin.x < rc_new.origin.x ? rc_old.origin.x : rc_new.origin.x;
+				int16_t y0 = rc_old.origin.y < rc_new.origin.y ? rc_old.origin.y : rc_new.origin.y;
+				int16_t x1 = grect_get_max_x(&rc_old) > grect_get_max_x(&rc_new) ? grect_get_max_x(&rc_old) : grect_get_max_x(&rc_new);
+				int16_t y1 = grect_get_max_y(&rc_old) > grect_get_max_y(&rc_new) ? grect_get_max_y(&rc_old) : grect_get_max_y(&rc_new);
+				secs_dirty = GRect(x0, y0, x1 - x0, y1 - y0);
+				b_secs_only = true;
+			}
+#endif
 			layer_mark_dirty(secs_layer);
 		}
 	}
@@ -198,28 +331,119 @@ static void handle_tick(struct tm *tick_time, TimeUnits units_changed)
 		vibes_enqueue_custom_pattern(vibe_pat); 	
 }
 //-----------------------------------------------------------------------------------------------------------------------
-static void timerCallback(void *data) 
+// Startup animation: hands sweep from 12:00 to the time read once at schedule,
+// interpolated from eased progress so late frames skip ahead instead of slowing down
+static void hands_anim_update(Animation *anim, const AnimationProgress progress)
 {
-	if (!b_initialized)
+	int16_t hh = anim_HH*progress/ANIMATION_NORMALIZED_MAX;
+	int16_t mm = anim_MM*progress/ANIMATION_NORMALIZED_MAX;
+	int16_t ss = anim_SS*progress/ANIMATION_NORMALIZED_MAX;
+	
+	if (hh != aktHH || mm != aktMM)
 	{
-		time_t temp = time(NULL);
-		struct tm *t = localtime(&temp);
-		int16_t step_max = 30;
-		
-		if (step <= step_max)
-		{
-			aktHH = (t->tm_hour % 12)*step/step_max;
-			aktMM = t->tm_min*step/step_max;
-			aktSS = t->tm_sec*step/step_max;
-			step++;
-			
-			timer = app_timer_register(TIMER_MS, timerCallback, NULL);
-			layer_mark_dirty(hands_layer);
-			layer_mark_dirty(secs_layer);
-		}
-		else
-			b_initialized = true;
+		aktHH = hh;
+		aktMM = mm;
+		layer_mark_dirty(hands_layer);
+	}
+	if (ss != aktSS)
+	{
+		aktSS = ss;
+		layer_mark_dirty(secs_layer);
+	}
+}
+//-----------------------------------------------------------------------------------------------------------------------
+static const AnimationImplementation hands_anim_impl = {
+	.update = hands_anim_update,
+};
+//-----------------------------------------------------------------------------------------------------------------------
+static void intro_anim_stopped(Animation *anim, bool finished, void *context)
+{
+	s_intro_anim = NULL;
+	if (!finished)
+		return;
+	
+	//Catch up with the time that passed during the animation
+	time_t temp = time(NULL);
+	struct tm *t = localtime(&temp);
+	b_initialized = true;
+	aktHH = t->tm_hour;
+	aktMM = t->tm_min;
+	aktSS = t->tm_sec;
+	layer_mark_dirty(hands_layer);
+	layer_mark_dirty(secs_layer);
+}
+//-----------------------------------------------------------------------------------------------------------------------
+// Schedules secs_timer shortly after the next multiple of showsec seconds
+static void secs_timer_schedule(void);
+
+static void secsTimerCallback(void *data) 
+{
+	time_t temp = time(NULL);
+	struct tm *t = localtime(&temp);
+	
+	//Second 0 comes with the minute tick
+	if (t->tm_sec != 0)
+		handle_tick(t, SECOND_UNIT);
+	
+	secs_timer_schedule();
+}
+//-----------------------------------------------------------------------------------------------------------------------
+static void secs_timer_schedule(void)
+{
+	time_t t;
+	uint16_t ms;
+	time_ms(&t, &ms);
+	
+	uint32_t wait = (CfgData.showsec - (t % 60) % CfgData.showsec) * 1000 - ms + 20;
+	secs_timer = app_timer_register(wait, secsTimerCallback, NULL);
+}
+//-----------------------------------------------------------------------------------------------------------------------
+// Wakes up only as often as showsec needs: every second, every 5-30 seconds by timer aligned to the interval
+// or just every minute
+static void subscribe_ticks(void)
+{
+	if (secs_timer)
+	{
+		app_timer_cancel(secs_timer);
+		secs_timer = NULL;
 	}
+	
+	tick_timer_service_subscribe(CfgData.showsec == 1 ? SECOND_UNIT : MINUTE_UNIT, handle_tick);
+	
+	if (CfgData.showsec > 1)
+		secs_timer_schedule();
+}
+//-----------------------------------------------------------------------------------------------------------------------
+static void batt_atlas_unload(void)
+{
+	for (int i = 0; i < BATT_SPRITES; i++)
+	{
+		if (batt_sprites[i])
+			gbitmap_destroy(batt_sprites[i]);
+		batt_sprites[i] = NULL;
+	}
+	if (batteryAll)
+		gbitmap_destroy(batteryAll);
+	batteryAll = NULL;
+	batt_index = batt_inv = -1;
+}
+//-----------------------------------------------------------------------------------------------------------------------
+// Loads the battery sheet of the theme and cuts all icons once, events only swap between them
+static void batt_atlas_load(bool inv)
+{
+	if (batt_inv == inv)
+		return;
+	
+	bitmap_layer_set_bitmap(battery_layer, NULL);
+	bitmap_layer_set_bitmap(radio_layer, NULL);
+	batt_atlas_unload();
+	
+	batteryAll = gbitmap_create_with_resource(inv ? RESOURCE_ID_IMAGE_BATTERY_INV : RESOURCE_ID_IMAGE_BATTERY);
+	for (int i = 0; i < BATT_SPRITES; i++)
+		batt_sprites[i] = gbitmap_create_as_sub_bitmap(batteryAll, GRect(10*i, 0, 10, 20));
+	batt_inv = inv;
+	
+	bitmap_layer_set_bitmap(radio_layer, batt_sprites[BATT_SPRITE_RADIO]);
 }
 //-----------------------------------------------------------------------------------------------------------------------
 void battery_state_service_handler(BatteryChargeState charge_state) 
@@ -230,132 +454,190 @@ void battery_state_service_handler(BatteryChargeState charge_state)
 	else 
 		nImage = 10 - (charge_state.charge_percent / 10);
 	
-	GRect sub_rect = GRect(10*nImage, 0, 10*nImage+10, 20);
-	bitmap_layer_set_bitmap(battery_layer, gbitmap_create_as_sub_bitmap(batteryAll, sub_rect));
+	if (nImage == batt_index)
+		return;
+	
+	batt_index = nImage;
+	b_secs_only = false;
+	bitmap_layer_set_bitmap(battery_layer, batt_sprites[nImage]);
 }
 //-----------------------------------------------------------------------------------------------------------------------
 void bluetooth_connection_handler(bool connected)
 {
+	b_secs_only = false;
 	layer_set_hidden(bitmap_layer_get_layer(radio_layer), connected != true);
 }
 //-----------------------------------------------------------------------------------------------------------------------
-static void update_configuration(void)
+// Configuration is stored as one CfgDta_t blob, settings of older versions (one key per value) are migrated once
+static void load_configuration(CfgDta_t *cfg)
 {
+	if (persist_exists(CONFIG_KEY_DATA) && 
+		persist_read_data(CONFIG_KEY_DATA, cfg, sizeof(CfgDta_t)) == sizeof(CfgDta_t) && 
+		cfg->version == CONFIG_VERSION)
+		return;
+	
+	cfg->version = CONFIG_VERSION;
+	
     if (persist_exists(CONFIG_KEY_INV))
-		CfgData.inv = persist_read_bool(CONFIG_KEY_INV);
+		cfg->inv = persist_read_bool(CONFIG_KEY_INV);
 	else	
-		CfgData.inv = false;
+		cfg->inv = false;
 	
     if (persist_exists(CONFIG_KEY_ANIM))
-		CfgData.anim = persist_read_bool(CONFIG_KEY_ANIM);
+		cfg->anim = persist_read_bool(CONFIG_KEY_ANIM);
 	else	
-		CfgData.anim = true;
+		cfg->anim = true;
 	
     if (persist_exists(CONFIG_KEY_SEP))
-		CfgData.sep = persist_read_bool(CONFIG_KEY_SEP);
+		cfg->sep = persist_read_bool(CONFIG_KEY_SEP);
 	else	
-		CfgData.sep = true;
+		cfg->sep = true;
 	
     if (persist_exists(CONFIG_KEY_VIBR))
-		CfgData.vibr = persist_read_bool(CONFIG_KEY_VIBR);
+		cfg->vibr = persist_read_bool(CONFIG_KEY_VIBR);
 	else	
-		CfgData.vibr = false;
+		cfg->vibr = false;
 	
     if (persist_exists(CONFIG_KEY_SHOWSEC))
-		CfgData.showsec = (int8_t)persist_read_int(CONFIG_KEY_SHOWSEC);
+		cfg->showsec = (int8_t)persist_read_int(CONFIG_KEY_SHOWSEC);
 	else	
-		CfgData.showsec = 1;
+		cfg->showsec = 1;
 	
     if (persist_exists(CONFIG_KEY_DATEFMT))
-		CfgData.datefmt = (int16_t)persist_read_int(CONFIG_KEY_DATEFMT);
+		cfg->datefmt = (int16_t)persist_read_int(CONFIG_KEY_DATEFMT);
 	else	
-		CfgData.datefmt = 0;
+		cfg->datefmt = 0;
+	
+	persist_write_data(CONFIG_KEY_DATA, cfg, sizeof(CfgDta_t));
+	for (uint32_t key = CONFIG_KEY_INV; key <= CONFIG_KEY_SHOWSEC; key++)
+		persist_delete(key);
+}
+//-----------------------------------------------------------------------------------------------------------------------
+static void save_configuration(const CfgDta_t *cfg)
+{
+	if (memcmp(cfg, &CfgData, sizeof(CfgDta_t)) != 0)
+		persist_write_data(CONFIG_KEY_DATA, cfg, sizeof(CfgDta_t));
+}
+//-----------------------------------------------------------------------------------------------------------------------
+// Applies cfg and touches only what depends on the changed values, b_all on window load sets up everything
+static void apply_configuration(const CfgDta_t *cfg, bool b_all)
+{
+	CfgDta_t old = CfgData;
+	CfgData = *cfg;
+	
+	bool b_inv = b_all || old.inv != cfg->inv;
+	bool b_secs = b_all || old.showsec != cfg->showsec;
+	bool b_redraw = b_inv || b_secs || old.sep != cfg->sep || old.datefmt != cfg->datefmt;
 	
 	app_log(APP_LOG_LEVEL_DEBUG, __FILE__, __LINE__, "Curr Conf: inv:%d, anim:%d, sep:%d, vibr:%d, showsec:%d, datefmt:%d",
 		CfgData.inv, CfgData.anim, CfgData.sep, CfgData.vibr, CfgData.showsec, CfgData.datefmt);
 
-	gbitmap_destroy(batteryAll);
-	batteryAll = gbitmap_create_with_resource(CfgData.inv ? RESOURCE_ID_IMAGE_BATTERY_INV : RESOURCE_ID_IMAGE_BATTERY);
-	
-	bitmap_layer_set_bitmap(radio_layer, NULL);
-	bitmap_layer_set_bitmap(radio_layer, gbitmap_create_as_sub_bitmap(batteryAll, GRect(110, 0, 10, 20)));
+	if (b_inv)
+	{
+		batt_atlas_load(CfgData.inv);
+		
+		if (face_inv != CfgData.inv)
+		{
+			gbitmap_destroy(bmp_face);
+			bmp_face = gbitmap_create_with_resource(CfgData.inv ? RESOURCE_ID_IMAGE_FACE_INV : RESOURCE_ID_IMAGE_FACE);
+			bitmap_layer_set_bitmap(face_layer, bmp_face);
+			face_inv = CfgData.inv;
+		}
+		text_layer_set_text_color(date_layer, theme_color(GColorWhite));
+	}
 	
 	Layer *window_layer = window_get_root_layer(window);
-	//GRect bounds = layer_get_bounds(window_get_root_layer(window));
 	
-	layer_remove_from_parent(secs_layer);
-	if (CfgData.showsec != 0)
-		layer_add_child(window_layer, secs_layer);
+	if (b_secs)
+	{
+		layer_remove_from_parent(secs_layer);
+		if (CfgData.showsec != 0)
+			layer_add_child(window_layer, secs_layer);
+		
+		subscribe_ticks();
+	}
 	
-	layer_remove_from_parent(inverter_layer_get_layer(inv_layer));
-	if (CfgData.inv)
+#ifdef NADIR_FRAME_STATS
+	//Keep statistics on top and start them over with new configuration
+	layer_remove_from_parent(effect_layer_get_layer(stats_layer));
+	layer_add_child(window_layer, effect_layer_get_layer(stats_layer));
+	effect_frame_stats_reset(&frame_stats);
+#endif
+	
+	if (b_redraw)
 	{
-		layer_remove_from_parent(bitmap_layer_get_layer(radio_layer));
-		layer_remove_from_parent(bitmap_layer_get_layer(battery_layer));
-		layer_add_child(window_layer, inverter_layer_get_layer(inv_layer));
-		layer_add_child(window_layer, bitmap_layer_get_layer(radio_layer));
-		layer_add_child(window_layer, bitmap_layer_get_layer(battery_layer));
+		//Get a time structure so that it doesn't start blank
+		time_t temp = time(NULL);
+		struct tm *t = localtime(&temp);
+		
+		//Manually call the tick handler to redraw with new settings
+		handle_tick(t, MINUTE_UNIT);
+		
+		//It only repaints the hands at a full minute, separator and date format live there too
+		layer_mark_dirty(hands_layer);
 	}
 	
-	//Get a time structure so that it doesn't start blank
-	time_t temp = time(NULL);
-	struct tm *t = localtime(&temp);
-
-	//Manually call the tick handler when the window is loading
-	handle_tick(t, MINUTE_UNIT);
-
-	//Set Battery state
-	BatteryChargeState btchg = battery_state_service_peek();
-	battery_state_service_handler(btchg);
+	//Set Battery state, icons are new after theme change
+	if (b_inv)
+	{
+		BatteryChargeState btchg = battery_state_service_peek();
+		battery_state_service_handler(btchg);
+	}
 	
 	//Set Bluetooth state
-	bool connected = bluetooth_connection_service_peek();
-	bluetooth_connection_handler(connected);
+	if (b_all)
+	{
+		bool connected = bluetooth_connection_service_peek();
+		bluetooth_connection_handler(connected);
+	}
+}
+//-----------------------------------------------------------------------------------------------------------------------
+// Second hand intervals the timers in subscribe_ticks handle: off, every second, every 5, 10, 15 or 30 seconds
+static bool showsec_valid(uint8_t showsec)
+{
+	switch (showsec)
+	{
+		case 0: case 1: case 5: case 10: case 15: case 30:
+			return true;
+		default:
+			return false;
+	}
 }
 //-----------------------------------------------------------------------------------------------------------------------
 void in_received_handler(DictionaryIterator *received, void *ctx)
 {
-	app_log(APP_LOG_LEVEL_DEBUG, __FILE__, __LINE__, "enter in_received_handler");
-    
-	Tuple *akt_tuple = dict_read_first(received);
-    while (akt_tuple)
-    {
-        app_log(APP_LOG_LEVEL_DEBUG,
-                __FILE__,
-                __LINE__,
-                "KEY %d=%s", (int16_t)akt_tuple->key,
-                akt_tuple->value->cstring);
-
-		if (akt_tuple->key == CONFIG_KEY_INV)
-			persist_write_bool(CONFIG_KEY_INV, strcmp(akt_tuple->value->cstring, "yes") == 0);
-		
-		if (akt_tuple->key == CONFIG_KEY_ANIM)
-			persist_write_bool(CONFIG_KEY_ANIM, strcmp(akt_tuple->value->cstring, "yes") == 0);
-		
-		if (akt_tuple->key == CONFIG_KEY_SEP)
-			persist_write_bool(CONFIG_KEY_SEP, strcmp(akt_tuple->value->cstring, "yes") == 0);
-		
-		if (akt_tuple->key == CONFIG_KEY_VIBR)
-			persist_write_bool(CONFIG_KEY_VIBR, strcmp(akt_tuple->value->cstring, "yes") == 0);
-		
-		if (akt_tuple->key == CONFIG_KEY_SHOWSEC)
-			persist_write_int(CONFIG_KEY_SHOWSEC, 
-				strcmp(akt_tuple->value->cstring, "nev") == 0 ? 0 : 
-				strcmp(akt_tuple->value->cstring, "05s") == 0 ? 5 : 
-				strcmp(akt_tuple->value->cstring, "10s") == 0 ? 10 : 
-				strcmp(akt_tuple->value->cstring, "15s") == 0 ? 15 : 
-				strcmp(akt_tuple->value->cstring, "30s") == 0 ? 30 : 1);
-		
-		if (akt_tuple->key == CONFIG_KEY_DATEFMT)
-			persist_write_int(CONFIG_KEY_DATEFMT, 
-				strcmp(akt_tuple->value->cstring, "fra") == 0 ? 1 : 
-				strcmp(akt_tuple->value->cstring, "eng") == 0 ? 2 : 
-				strcmp(akt_tuple->value->cstring, "usa") == 0 ? 3 : 0);
-		
-		akt_tuple = dict_read_next(received);
+	Tuple *akt_tuple = dict_find(received, CONFIG_KEY_MSG);
+	if (!akt_tuple || akt_tuple->type != TUPLE_BYTE_ARRAY || akt_tuple->length != CONFIG_MSG_SIZE || 
+		akt_tuple->value->data[0] != CONFIG_MSG_VERSION)
+	{
+		app_log(APP_LOG_LEVEL_WARNING, __FILE__, __LINE__, "Unknown config message");
+		return;
 	}
 	
-    update_configuration();
+	uint8_t mask = akt_tuple->value->data[1];
+	const uint8_t *val = akt_tuple->value->data + 2;
+	CfgDta_t cfg = CfgData;
+	
+	if (mask & (1 << CONFIG_MSG_INV))
+		cfg.inv = val[CONFIG_MSG_INV] != 0;
+	
+	if (mask & (1 << CONFIG_MSG_ANIM))
+		cfg.anim = val[CONFIG_MSG_ANIM] != 0;
+	
+	if (mask & (1 << CONFIG_MSG_SEP))
+		cfg.sep = val[CONFIG_MSG_SEP] != 0;
+	
+	if (mask & (1 << CONFIG_MSG_VIBR))
+		cfg.vibr = val[CONFIG_MSG_VIBR] != 0;
+	
+	if (mask & (1 << CONFIG_MSG_SHOWSEC) && showsec_valid(val[CONFIG_MSG_SHOWSEC]))
+		cfg.showsec = val[CONFIG_MSG_SHOWSEC];
+	
+	if (mask & (1 << CONFIG_MSG_DATEFMT) && val[CONFIG_MSG_DATEFMT] <= 3)
+		cfg.datefmt = val[CONFIG_MSG_DATEFMT];
+	
+	save_configuration(&cfg);
+	apply_configuration(&cfg, false);
 }
 //-----------------------------------------------------------------------------------------------------------------------
 void in_dropped_handler(AppMessageResult reason, void *ctx)
@@ -370,13 +652,28 @@ void in_dropped_handler(AppMessageResult reason, void *ctx)
 static void window_load(Window *window) 
 {
 	Layer *window_layer = window_get_root_layer(window);
-	window_set_background_color(window, GColorBlack);
+	window_set_background_color(window, GColorClear);
 	GRect bounds = layer_get_bounds(window_layer);
 	
 	digitS = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_DIGITAL_24));
 	
+#ifdef NADIR_FRAME_STATS
+	//Frame statistics, mark below all other layers starts render time
+	stats_mark_layer = effect_layer_create(bounds);
+	effect_layer_add_effect(stats_mark_layer, effect_frame_stats_mark, &frame_stats);
+	layer_add_child(window_layer, effect_layer_get_layer(stats_mark_layer));
+	stats_layer = effect_layer_create(bounds);
+	effect_layer_add_effect(stats_layer, effect_frame_stats, &frame_stats);
+#endif
+	
+	//Background cache restore, below face
+	bg_layer = layer_create(bounds);
+	layer_set_update_proc(bg_layer, bg_update_proc);
+	layer_add_child(window_layer, bg_layer);
+	
 	// Init layers
 	bmp_face = gbitmap_create_with_resource(RESOURCE_ID_IMAGE_FACE);
+	face_inv = 0;
 	GRect rc = gbitmap_get_bounds(bmp_face);
 #if defined(PBL_RECT)
 	face_layer = bitmap_layer_create(GRect(bounds.size.w/2-rc.size.w/2, bounds.size.w/2-rc.size.h/2, rc.size.w, rc.size.h));
@@ -399,14 +696,17 @@ static void window_load(Window *window)
 	layer_set_update_proc(secs_layer, secs_update_proc);
 	
 	date_layer = text_layer_create(GRect(0, bounds.size.w-3, bounds.size.w, bounds.size.h-bounds.size.w+3));
-	text_layer_set_text_color(date_layer, GColorWhite);
 	text_layer_set_background_color(date_layer, GColorClear);
 	text_layer_set_text_alignment(date_layer, GTextAlignmentCenter);
 	text_layer_set_font(date_layer, digitS);
 	layer_add_child(window_layer, text_layer_get_layer(date_layer));
+	
+	//Background cache capture, above everything that changes once a minute
+	capture_layer = layer_create(bounds);
+	layer_set_update_proc(capture_layer, capture_update_proc);
+	layer_add_child(window_layer, capture_layer);
 
-	//Init battery
-	batteryAll = gbitmap_create_with_resource(RESOURCE_ID_IMAGE_BATTERY);
+	//Init battery, icons are set by apply_configuration
 	battery_layer = bitmap_layer_create(GRect(bounds.size.w-11, bounds.size.h, 10, 20)); 
 	bitmap_layer_set_background_color(battery_layer, GColorClear);
 	layer_add_child(window_layer, bitmap_layer_get_layer(battery_layer));
@@ -414,14 +714,12 @@ static void window_load(Window *window)
 	//Init bluetooth radio
 	radio_layer = bitmap_layer_create(GRect(1, bounds.size.h, 10, 20));
 	bitmap_layer_set_background_color(radio_layer, GColorClear);
-	bitmap_layer_set_bitmap(radio_layer, gbitmap_create_as_sub_bitmap(batteryAll, GRect(110, 0, 10, 20)));
 	layer_add_child(window_layer, bitmap_layer_get_layer(radio_layer));
 	
-	//Init Inverter Layer
-	inv_layer = inverter_layer_create(bounds);	
-	
-	//Update Configuration
-	update_configuration();
+	//Load and apply Configuration
+	CfgDta_t cfg;
+	load_configuration(&cfg);
+	apply_configuration(&cfg, true);
 	
 	//Start|Skip Animation
 	if (CfgData.anim)
@@ -440,7 +738,6 @@ static void window_load(Window *window)
 		animation_set_curve((Animation*)s_prop_anim_bt, AnimationCurveEaseOut);
 		animation_set_delay((Animation*)s_prop_anim_bt, 0);
 		animation_set_duration((Animation*)s_prop_anim_bt, 1000);
-		animation_schedule((Animation*)s_prop_anim_bt);
 		
 		//Animate Battery
 		rc_from = layer_get_frame(bitmap_layer_get_layer(battery_layer));
@@ -456,11 +753,25 @@ static void window_load(Window *window)
 		animation_set_curve((Animation*)s_prop_anim_batt, AnimationCurveEaseOut);
 		animation_set_delay((Animation*)s_prop_anim_batt, 500);
 		animation_set_duration((Animation*)s_prop_anim_batt, 1000);
-		animation_schedule((Animation*)s_prop_anim_batt);
 		
 		//Animate Hands
-		step = aktHH = aktMM = aktSS = 0;
-		timerCallback(NULL);
+		time_t temp = time(NULL);
+		struct tm *t = localtime(&temp);
+		anim_HH = t->tm_hour % 12;
+		anim_MM = t->tm_min;
+		anim_SS = t->tm_sec;
+		aktHH = aktMM = aktSS = 0;
+		Animation *hands_anim = animation_create();
+		animation_set_implementation(hands_anim, &hands_anim_impl);
+		animation_set_curve(hands_anim, AnimationCurveEaseOut);
+		animation_set_duration(hands_anim, 3000);
+		
+		//One timeline for icons and hands
+		s_intro_anim = animation_spawn_create((Animation*)s_prop_anim_bt, (Animation*)s_prop_anim_batt, hands_anim, NULL);
+		animation_set_handlers(s_intro_anim, (AnimationHandlers) {
+			.stopped = intro_anim_stopped,
+		}, NULL);
+		animation_schedule(s_intro_anim);
 	}	
 	else
 		b_initialized = true;
@@ -468,18 +779,31 @@ static void window_load(Window *window)
 //-----------------------------------------------------------------------------------------------------------------------
 static void window_unload(Window *window) 
 {
+	if (s_intro_anim)
+		animation_unschedule(s_intro_anim);
 	layer_destroy(secs_layer);
 	layer_destroy(hands_layer);
+	layer_destroy(capture_layer);
+	layer_destroy(bg_layer);
+	free(cache_data);
+	cache_data = NULL;
+	b_cache_valid = b_cache_used = false;
 	text_layer_destroy(date_layer);
 	bitmap_layer_destroy(battery_layer);
 	bitmap_layer_destroy(radio_layer);
 	bitmap_layer_destroy(face_layer);
-	inverter_layer_destroy(inv_layer);
+#ifdef NADIR_FRAME_STATS
+	effect_layer_destroy(stats_layer);
+	effect_layer_destroy(stats_mark_layer);
+#endif
 	fonts_unload_custom_font(digitS);
-	gbitmap_destroy(batteryAll);
+	batt_atlas_unload();
 	gbitmap_destroy(bmp_face);
-	if (!b_initialized)
-		app_timer_cancel(timer);
+	if (secs_timer)
+	{
+		app_timer_cancel(secs_timer);
+		secs_timer = NULL;
+	}
 }
 //-----------------------------------------------------------------------------------------------------------------------
 static void init(void) 
@@ -492,19 +816,9 @@ static void init(void)
 		.unload = window_unload,
 	});
 
-	// Init paths
-	hour_path = gpath_create(&HOUR_PATH_INFO);
-	mins_path = gpath_create(&MINS_PATH_INFO);
-	secs_path = gpath_create(&SECS_PATH_INFO);
-	hour2_path = gpath_create(&HOUR2_PATH_INFO);
-	mins2_path = gpath_create(&MINS2_PATH_INFO);
-	
 	// Push the window onto the stack
 	window_stack_push(window, true);
 	
-	//Subscribe ticks
-	tick_timer_service_subscribe(SECOND_UNIT, handle_tick);
-
 	//Subscribe smart status
 	battery_state_service_subscribe(&battery_state_service_handler);
 	bluetooth_connection_service_subscribe(&bluetooth_connection_handler);
@@ -512,7 +826,8 @@ static void init(void)
 	//Subscribe messages
 	app_message_register_inbox_received(in_received_handler);
     app_message_register_inbox_dropped(in_dropped_handler);
-    app_message_open(128, 128);
+    //Only the config message is received, nothing is sent from the watch
+    app_message_open(dict_calc_buffer_size(1, CONFIG_MSG_SIZE), 0);
 }
 //-----------------------------------------------------------------------------------------------------------------------
 static void deinit(void) 
@@ -522,12 +837,6 @@ static void deinit(void)
 	battery_state_service_unsubscribe();
 	bluetooth_connection_service_unsubscribe();
 	
-	gpath_destroy(hour_path);
-	gpath_destroy(mins_path);
-	gpath_destroy(secs_path);
-	gpath_destroy(hour2_path);
-	gpath_destroy(mins2_path);
-	
 	window_destroy(window);
 }
 //-----------------------------------------------------------------------------------------------------------------------
@@ -139,4 +139,149 @@ float my_asin (float x)
 float my_tan(float x)
 {
   return my_sin(x) / my_cos(x);
-}
\ No newline at end of file
+}
+
+/*
+ * Fixed point math
+ */
+
+#define FX_QUARTER 0x4000 // quarter of a turn in TRIG_MAX_ANGLE units
+
+/* sin over [0, quarter turn] in 256 steps, Q16 (last entry is 1.0 - 1 LSB to fit uint16_t) */
+static const uint16_t sin_table[257] = {
+  0, 402, 804, 1206, 1608, 2010, 2412, 2814, 3216, 3617, 4019, 4420, 4821, 5222, 5623, 6023,
+  6424, 6824, 7224, 7623, 8022, 8421, 8820, 9218, 9616, 10014, 10411, 10808, 11204, 11600, 11996, 12391,
+  12785, 13180, 13573, 13966, 14359, 14751, 15143, 15534, 15924, 16314, 16703, 17091, 17479, 17867, 18253, 18639,
+  19024, 19409, 19792, 20175, 20557, 20939, 21320, 21699, 22078, 22457, 22834, 23210, 23586, 23961, 24335, 24708,
+  25080, 25451, 25821, 26190, 26558, 26925, 27291, 27656, 28020, 28383, 28745, 29106, 29466, 29824, 30182, 30538,
+  30893, 31248, 31600, 31952, 32303, 32652, 33000, 33347, 33692, 34037, 34380, 34721, 35062, 35401, 35738, 36075,
+  36410, 36744, 37076, 37407, 37736, 38064, 38391, 38716, 39040, 39362, 39683, 40002, 40320, 40636, 40951, 41264,
+  41576, 41886, 42194, 42501, 42806, 43110, 43412, 43713, 44011, 44308, 44604, 44898, 45190, 45480, 45769, 46056,
+  46341, 46624, 46906, 47186, 47464, 47741, 48015, 48288, 48559, 48828, 49095, 49361, 49624, 49886, 50146, 50404,
+  50660, 50914, 51166, 51417, 51665, 51911, 52156, 52398, 52639, 52878, 53114, 53349, 53581, 53812, 54040, 54267,
+  54491, 54714, 54934, 55152, 55368, 55582, 55794, 56004, 56212, 56418, 56621, 56823, 57022, 57219, 57414, 57607,
+  57798, 57986, 58172, 58356, 58538, 58718, 58896, 59071, 59244, 59415, 59583, 59750, 59914, 60075, 60235, 60392,
+  60547, 60700, 60851, 60999, 61145, 61288, 61429, 61568, 61705, 61839, 61971, 62101, 62228, 62353, 62476, 62596,
+  62714, 62830, 62943, 63054, 63162, 63268, 63372, 63473, 63572, 63668, 63763, 63854, 63944, 64031, 64115, 64197,
+  64277, 64354, 64429, 64501, 64571, 64639, 64704, 64766, 64827, 64884, 64940, 64993, 65043, 65091, 65137, 65180,
+  65220, 65259, 65294, 65328, 65358, 65387, 65413, 65436, 65457, 65476, 65492, 65505, 65516, 65525, 65531, 65535,
+  65535
+};
+
+/* asin over [0, 0.5] in 256 steps, TRIG_MAX_ANGLE units */
+static const uint16_t asin_table[257] = {
+  0, 20, 41, 61, 81, 102, 122, 143, 163, 183, 204, 224, 244, 265, 285, 306,
+  326, 346, 367, 387, 408, 428, 448, 469, 489, 509, 530, 550, 571, 591, 612, 632,
+  652, 673, 693, 714, 734, 754, 775, 795, 816, 836, 857, 877, 897, 918, 938, 959,
+  979, 1000, 1020, 1041, 1061, 1082, 1102, 1123, 1143, 1164, 1184, 1205, 1225, 1246, 1266, 1287,
+  1307, 1328, 1348, 1369, 1389, 1410, 1431, 1451, 1472, 1492, 1513, 1533, 1554, 1575, 1595, 1616,
+  1636, 1657, 1678, 1698, 1719, 1740, 1760, 1781, 1802, 1822, 1843, 1864, 1884, 1905, 1926, 1947,
+  1967, 1988, 2009, 2030, 2050, 2071, 2092, 2113, 2134, 2154, 2175, 2196, 2217, 2238, 2259, 2279,
+  2300, 2321, 2342, 2363, 2384, 2405, 2426, 2447, 2468, 2489, 2510, 2530, 2551, 2572, 2593, 2615,
+  2636, 2657, 2678, 2699, 2720, 2741, 2762, 2783, 2804, 2825, 2847, 2868, 2889, 2910, 2931, 2952,
+  2974, 2995, 3016, 3037, 3059, 3080, 3101, 3123, 3144, 3165, 3187, 3208, 3229, 3251, 3272, 3294,
+  3315, 3336, 3358, 3379, 3401, 3422, 3444, 3466, 3487, 3509, 3530, 3552, 3573, 3595, 3617, 3638,
+  3660, 3682, 3704, 3725, 3747, 3769, 3791, 3812, 3834, 3856, 3878, 3900, 3922, 3944, 3965, 3987,
+  4009, 4031, 4053, 4075, 4097, 4120, 4142, 4164, 4186, 4208, 4230, 4252, 4275, 4297, 4319, 4341,
+  4364, 4386, 4408, 4430, 4453, 4475, 4498, 4520, 4543, 4565, 4588, 4610, 4633, 4655, 4678, 4700,
+  4723, 4746, 4768, 4791, 4814, 4837, 4859, 4882, 4905, 4928, 4951, 4974, 4997, 5020, 5043, 5066,
+  5089, 5112, 5135, 5158, 5181, 5204, 5228, 5251, 5274, 5297, 5321, 5344, 5367, 5391, 5414, 5438,
+  5461
+};
+
+/* sin of q in [0, FX_QUARTER] */
+static int32_t sin_quarter(uint32_t q)
+{
+  uint32_t i = q >> 6, f = q & 63;
+  if (f == 0) return sin_table[i];
+  return sin_table[i] + (((sin_table[i + 1] - sin_table[i]) * f) >> 6);
+}
+
+void fx_sincos(int32_t angle, int32_t *sin, int32_t *cos)
+{
+  uint32_t a = (uint32_t)angle & 0xFFFF;
+  uint32_t r = a & (FX_QUARTER - 1);
+  int32_t s = sin_quarter(r), c = sin_quarter(FX_QUARTER - r);
+  
+  switch (a / FX_QUARTER) {
+    case 0: *sin = s; *cos = c; break;
+    case 1: *sin = c; *cos = -s; break;
+    case 2: *sin = -s; *cos = -c; break;
+    default: *sin = -c; *cos = s; break;
+  }
+}
+
+int32_t fx_sin(int32_t angle)
+{
+  uint32_t a = (uint32_t)angle & 0xFFFF;
+  uint32_t r = a & (FX_QUARTER - 1);
+  int32_t s = (a & FX_QUARTER) ? sin_quarter(FX_QUARTER - r) : sin_quarter(r);
+  return (a & (2 * FX_QUARTER)) ? -s : s;
+}
+
+int32_t fx_cos(int32_t angle)
+{
+  return fx_sin((angle & 0xFFFF) + FX_QUARTER); /* one turn is 0x10000, wrapping first keeps the sum in range */
+}
+
+int32_t fx_tan(int32_t angle)
+{
+  int32_t s, c;
+  fx_sincos(angle, &s, &c);
+  if (c == 0) return s < 0 ? -INT32_MAX : INT32_MAX;
+  int64_t t = (int64_t)s * FX_ONE / c;
+  if (t > INT32_MAX) return INT32_MAX;
+  if (t < -INT32_MAX) return -INT32_MAX;
+  return t;
+}
+
+/* bit by bit integer square root */
+static uint32_t isqrt64(uint64_t v)
+{
+  uint64_t res = 0, bit = (uint64_t)1 << 62;
+  while (bit > v) bit >>= 2;
+  while (bit) {
+    if (v >= res + bit) {
+      v -= res + bit;
+      res = (res >> 1) + bit;
+    } else {
+      res >>= 1;
+    }
+    bit >>= 2;
+  }
+  return res;
+}
+
+uint32_t fx_sqrt(uint32_t x)
+{
+  return isqrt64((uint64_t)x << 16);
+}
+
+/* asin of x in [0, FX_ONE / 2] */
+static int32_t asin_half(uint32_t x)
+{
+  uint32_t i = x >> 7, f = x & 127;
+  if (f == 0) return asin_table[i];
+  return asin_table[i] + (((asin_table[i + 1] - asin_table[i]) * f) >> 7);
+}
+
+int32_t fx_asin(int32_t ratio)
+{
+  /* clamp before negating, -INT32_MIN overflows */
+  if (ratio > FX_ONE) ratio = FX_ONE;
+  if (ratio < -FX_ONE) ratio = -FX_ONE;
+  uint32_t xa = ratio < 0 ? -ratio : ratio;
+  int32_t a;
+  /* same reduction as my_acos: arcsin(x) = pi/2 - 2 * arcsin (sqrt ((1-x) / 2)) keeps the table off the steep end */
+  if (xa <= FX_ONE / 2) {
+    a = asin_half(xa);
+  } else {
+    a = FX_QUARTER - 2 * asin_half(isqrt64((uint64_t)(FX_ONE - xa) << 15));
+  }
+  return ratio < 0 ? -a : a;
+}
+
+int32_t fx_acos(int32_t ratio)
+{
+  return FX_QUARTER - fx_asin(ratio);
+}
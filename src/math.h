@@ -1,5 +1,6 @@
 //Taken from Michael Ehrmann source code of SunClock https://github.com/mehrmann/pebble-sunclock
 #pragma once
+#include <pebble.h>
 
 #define M_PI 3.141592653589793
 float my_sqrt(const float x);
@@ -11,4 +12,16 @@ float my_sin (float x);
 float my_cos(float x);
 float my_acos (float x);
 float my_asin (float x);
-float my_tan(float x);
\ No newline at end of file
+float my_tan(float x);
+
+// Fixed point versions of the above, no floats involved (none of the Pebbles has an FPU).
+// Angles are in TRIG_MAX_ANGLE units (0x10000 per turn), ratios are Q16 (FX_ONE == 1.0, about TRIG_MAX_RATIO).
+// Table lookup with linear interpolation, errors are within a few LSB.
+#define FX_ONE 0x10000
+int32_t fx_sin(int32_t angle);
+int32_t fx_cos(int32_t angle);
+void fx_sincos(int32_t angle, int32_t *sin, int32_t *cos);
+int32_t fx_tan(int32_t angle); // saturates to +-INT32_MAX at +-90 degrees
+int32_t fx_asin(int32_t ratio); // ratio clamped to [-FX_ONE, FX_ONE], result in [-TRIG_MAX_ANGLE/4, TRIG_MAX_ANGLE/4]
+int32_t fx_acos(int32_t ratio); // result in [0, TRIG_MAX_ANGLE/2]
+uint32_t fx_sqrt(uint32_t x); // Q16 in, Q16 out
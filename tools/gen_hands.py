@@ -0,0 +1,137 @@
+#!/usr/bin/env python
+#
+# Generates the hand geometry tables included by src/main.c as "src/hand_tables.auto.h".
+#
+# Every hand position is rotated and moved here the same way hands_update_proc did it at
+# runtime with sin_lookup/cos_lookup and gpath_rotate_to, so the watch only picks a row.
+# Vertices are stored relative to the hand center as int8 {x, y} pairs.
+#
+# Usage: gen_hands.py <platform> <output header>
+#
+
+import math
+import sys
+
+TRIG_MAX_RATIO = 0xffff
+TRIG_MAX_ANGLE = 0x10000
+
+HAND_RADIUS = 36
+SECS_RADIUS = HAND_RADIUS - 14
+
+HOUR_POINTS = [(0, 0), (-6, -11), (-2, -16), (-2, -33), (2, -33), (2, -16), (6, -11)]
+HOUR2_POINTS = [(0, -2), (-4, -11), (-2, -14), (2, -14), (4, -11)]
+MINS_POINTS = [(0, 0), (-5, -11), (-2, -15), (-2, -38), (2, -38), (2, -15), (5, -11)]
+MINS2_POINTS = [(0, -2), (-3, -11), (-1, -13), (1, -13), (3, -11)]
+SECS_POINTS = [(0, 0), (-4, -11), (-2, -13), (-2, -38), (2, -38), (2, -13), (4, -11)]
+
+
+def cdiv(a, b):
+    # C integer division, truncates toward zero
+    q = abs(a) // abs(b)
+    return q if (a < 0) == (b < 0) else -q
+
+
+def sin_lookup(angle):
+    return int(round(math.sin(2 * math.pi * angle / TRIG_MAX_ANGLE) * TRIG_MAX_RATIO))
+
+
+def cos_lookup(angle):
+    return int(round(math.cos(2 * math.pi * angle / TRIG_MAX_ANGLE) * TRIG_MAX_RATIO))
+
+
+def hand_origin(angle, rad):
+    return (cdiv(sin_lookup(angle) * rad, TRIG_MAX_RATIO), cdiv(-cos_lookup(angle) * rad, TRIG_MAX_RATIO))
+
+
+def rotate(points, angle, origin):
+    # same as gpath_rotate_to + gpath_move_to
+    s, c = sin_lookup(angle), cos_lookup(angle)
+    return [(cdiv(x * c, TRIG_MAX_RATIO) - cdiv(y * s, TRIG_MAX_RATIO) + origin[0],
+             cdiv(y * c, TRIG_MAX_RATIO) + cdiv(x * s, TRIG_MAX_RATIO) + origin[1]) for x, y in points]
+
+
+def hour_angle(pos):
+    return TRIG_MAX_ANGLE * pos // 72
+
+
+def minute_angle(pos):
+    return TRIG_MAX_ANGLE * pos // 60
+
+
+def hand_table(points, positions, angle):
+    return [rotate(points, angle(pos), hand_origin(angle(pos), HAND_RADIUS)) for pos in range(positions)]
+
+
+def secs_table():
+    return [rotate(SECS_POINTS, minute_angle((ss + 30) % 60), hand_origin(minute_angle(ss), SECS_RADIUS))
+            for ss in range(60)]
+
+
+def bounds(table):
+    return [(min(x for x, _ in pts), min(y for _, y in pts), max(x for x, _ in pts), max(y for _, y in pts))
+            for pts in table]
+
+
+def check_int8(name, values):
+    if not all(-128 <= v <= 127 for v in values):
+        raise ValueError('%s does not fit into int8' % name)
+
+
+def emit_points(out, name, table):
+    out.append('static const int8_t %s[%d][%d][2] = {' % (name, len(table), len(table[0])))
+    for row in table:
+        check_int8(name, [c for v in row for c in v])
+        out.append('\t{' + ', '.join('{%d, %d}' % v for v in row) + '},')
+    out.append('};')
+    return len(table) * len(table[0]) * 2
+
+
+def emit_boxes(out, name, table):
+    out.append('static const int8_t %s[%d][4] = {' % (name, len(table)))
+    for row in table:
+        check_int8(name, row)
+        out.append('\t{%d, %d, %d, %d},' % row)
+    out.append('};')
+    return len(table) * 4
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.stderr.write('usage: %s <platform> <output header>\n' % sys.argv[0])
+        return 1
+    platform, path = sys.argv[1], sys.argv[2]
+
+    secs = secs_table()
+    out = ['// Generated by tools/gen_hands.py for %s, do not edit.' % platform,
+           '// Hand vertices for every position, {x, y} relative to the hand center.',
+           '#pragma once',
+           '',
+           '#define HOUR_HAND_POSITIONS 72',
+           '#define MINS_HAND_POSITIONS 60',
+           '#define SECS_HAND_POSITIONS 60',
+           '#define HOUR_HAND_POINTS %d' % len(HOUR_POINTS),
+           '#define HOUR2_HAND_POINTS %d' % len(HOUR2_POINTS),
+           '#define MINS_HAND_POINTS %d' % len(MINS_POINTS),
+           '#define MINS2_HAND_POINTS %d' % len(MINS2_POINTS),
+           '#define SECS_HAND_POINTS %d' % len(SECS_POINTS),
+           '']
+    size = 0
+    size += emit_points(out, 'HOUR_HAND', hand_table(HOUR_POINTS, 72, hour_angle))
+    size += emit_points(out, 'HOUR2_HAND', hand_table(HOUR2_POINTS, 72, hour_angle))
+    size += emit_points(out, 'MINS_HAND', hand_table(MINS_POINTS, 60, minute_angle))
+    size += emit_points(out, 'MINS2_HAND', hand_table(MINS2_POINTS, 60, minute_angle))
+    size += emit_points(out, 'SECS_HAND', secs)
+    out.append('')
+    out.append('// {x0, y0, x1, y1} of the second hand vertices')
+    size += emit_boxes(out, 'SECS_HAND_BOX', bounds(secs))
+    out.append('')
+    out.append('// %d bytes of flash' % size)
+
+    with open(path, 'w') as f:
+        f.write('\n'.join(out) + '\n')
+    print('hand tables for %s: %d bytes of flash' % (platform, size))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,303 @@
+// Times every effect on the framebuffer of the platform the binary is built for, see Makefile.
+// Each run starts from the same test picture; the reported figures are ns per pixel and pixels/s of the effect area
+// (best of BENCH_ROUNDS averages, host CPU - compare numbers between builds, not with the watch).
+#include "pebble_host.h"
+#include "../../src/effects.h"
+#include "../../src/effect_layer.h"
+#include "../../src/hand_raster.h"
+#include "src/hand_tables.auto.h" // generated by tools/gen_hands.py, see Makefile
+
+#define BENCH_ROUNDS 3
+#define BENCH_MIN_NS 5000000 // time spent in one round
+
+typedef struct {
+  const char *name;
+  effect_cb *effect;
+  void *param;
+} BenchEffect;
+
+// an optimization measured against the code it replaced
+typedef struct {
+  const char *name;
+  BenchEffect before, after;
+} BenchPair;
+
+// effect_invert before the BitmapRow conversion: every pixel looked up through get_pixel/set_pixel, which
+// compute the row address (and on Chalk fetch the row info) on each call
+static void baseline_set_pixel(BitmapInfo bitmap_info, int y, int x, uint8_t color) {
+#ifndef PBL_PLATFORM_APLITE
+  if (bitmap_info.bitmap_format == GBitmapFormat1BitPalette) {
+#else
+  if (bitmap_info.bitmap_format == GBitmapFormat1Bit) {
+#endif
+    bitmap_info.bitmap_data[y*bitmap_info.bytes_per_row + x / 8] ^= (-color ^ bitmap_info.bitmap_data[y*bitmap_info.bytes_per_row + x / 8]) & (1 << (x % 8));
+  } else {
+  #ifndef PBL_PLATFORM_CHALK
+    bitmap_info.bitmap_data[y*bitmap_info.bytes_per_row + x] = color;
+  #else
+    GBitmapDataRowInfo info = gbitmap_get_data_row_info(bitmap_info.bitmap, y);
+    if ((x >= info.min_x) && (x <= info.max_x)) info.data[x] = color;
+  #endif
+  }
+}
+
+static uint8_t baseline_get_pixel(BitmapInfo bitmap_info, int y, int x) {
+#ifndef PBL_PLATFORM_APLITE
+  if (bitmap_info.bitmap_format == GBitmapFormat1BitPalette) {
+    return (bitmap_info.bitmap_data[y*bitmap_info.bytes_per_row + x / 8] << (x % 8)) & 128;
+#else
+  if (bitmap_info.bitmap_format == GBitmapFormat1Bit) {
+    return (bitmap_info.bitmap_data[y*bitmap_info.bytes_per_row + x / 8] >> (x % 8)) & 1;
+#endif
+  } else {
+  #ifndef PBL_PLATFORM_CHALK
+    return bitmap_info.bitmap_data[y*bitmap_info.bytes_per_row + x];
+  #else
+    GBitmapDataRowInfo info = gbitmap_get_data_row_info(bitmap_info.bitmap, y);
+    if ((x >= info.min_x) && (x <= info.max_x))
+      return info.data[x];
+    else
+      return -1;
+  #endif
+  }
+}
+
+static void baseline_effect_invert(GContext* ctx, GRect position, void* param) {
+  GBitmap *fb = graphics_capture_frame_buffer(ctx);
+
+  BitmapInfo bitmap_info;
+  bitmap_info_init(&bitmap_info, fb);
+
+  for (int y = 0; y < position.size.h; y++)
+    for (int x = 0; x < position.size.w; x++)
+    #ifdef PBL_COLOR
+      baseline_set_pixel(bitmap_info, y + position.origin.y, x + position.origin.x, (~baseline_get_pixel(bitmap_info, y + position.origin.y, x + position.origin.x))|0xC0);
+    #else
+      baseline_set_pixel(bitmap_info, y + position.origin.y, x + position.origin.x, 1 - baseline_get_pixel(bitmap_info, y + position.origin.y, x + position.origin.x));
+    #endif
+
+  graphics_release_frame_buffer(ctx, fb);
+}
+
+// hands as they were drawn before hand_raster: gpath_draw_filled and gpath_draw_outline work like the firmware ones,
+// a scanline fill intersecting every edge on each row and a Bresenham line per edge, each pixel going through a
+// clipped pixel write that looks its row up again
+static void gpath_plot(BitmapInfo *bitmap_info, int x, int y, uint8_t color) {
+  BitmapRow row;
+  bitmap_row_begin(&row, bitmap_info, y);
+  bitmap_row_set(&row, x, color);
+}
+
+static void gpath_fill(BitmapInfo *bitmap_info, const int8_t (*points)[2], int n, GPoint center, uint8_t color) {
+  int y0 = INT16_MAX, y1 = INT16_MIN;
+  for (int i = 0; i < n; i++) {
+    if (points[i][1] < y0) y0 = points[i][1];
+    if (points[i][1] > y1) y1 = points[i][1];
+  }
+  for (int y = y0; y <= y1; y++) {
+    int16_t xs[HAND_RASTER_MAX_POINTS];
+    int k = 0;
+    for (int i = 0; i < n; i++) {
+      const int8_t *a = points[i], *b = points[(i + 1) % n];
+      if ((a[1] <= y && b[1] > y) || (b[1] <= y && a[1] > y)) {
+        // crossing in 1/8 pixel as the firmware's Fixed_S16_3
+        int x = (a[0] * 8 + (y - a[1]) * (b[0] - a[0]) * 8 / (b[1] - a[1]) + 4) / 8;
+        int j = k++;
+        for (; j > 0 && xs[j - 1] > x; j--) xs[j] = xs[j - 1];
+        xs[j] = x;
+      }
+    }
+    for (int i = 0; i + 1 < k; i += 2)
+      for (int x = xs[i]; x <= xs[i + 1]; x++) gpath_plot(bitmap_info, center.x + x, center.y + y, color);
+  }
+}
+
+static void gpath_line(BitmapInfo *bitmap_info, int x0, int y0, int x1, int y1, uint8_t color) {
+  int dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+  int dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+  int err = dx + dy;
+  for (;;) {
+    gpath_plot(bitmap_info, x0, y0, color);
+    if (x0 == x1 && y0 == y1) break;
+    int e2 = 2 * err;
+    if (e2 >= dy) { err += dy; x0 += sx; }
+    if (e2 <= dx) { err += dx; y0 += sy; }
+  }
+}
+
+static void gpath_draw(GContext *ctx, GPoint center, const HandPolygon *polygons, uint8_t count) {
+  GBitmap *fb = graphics_capture_frame_buffer(ctx);
+  BitmapInfo bitmap_info;
+  bitmap_info_init(&bitmap_info, fb);
+  for (uint8_t p = 0; p < count; p++) {
+    const HandPolygon *hand = &polygons[p];
+    uint8_t color = COLOR_FALLBACK(hand->color.argb, gcolor_equal(hand->color, GColorWhite) ? 1 : 0);
+    gpath_fill(&bitmap_info, hand->points, hand->num_points, center, color);
+    if (hand->fill_only) continue;
+    for (int i = 0; i < hand->num_points; i++) {
+      const int8_t *a = hand->points[i], *b = hand->points[(i + 1) % hand->num_points];
+      gpath_line(&bitmap_info, center.x + a[0], center.y + a[1], center.x + b[0], center.y + b[1], color);
+    }
+  }
+  graphics_release_frame_buffer(ctx, fb);
+}
+
+// hour and minute hands (bodies and insets) at all 720 minutes of the dial, or the second hand at all 60 seconds
+static void draw_hands(bool raster, bool secs) {
+  GContext *ctx = host_context();
+  GRect bounds = gbitmap_get_bounds(host_framebuffer());
+  GPoint center = grect_center_point(&bounds);
+  for (int t = 0; t < (secs ? 60 : 720); t++) {
+    int hh = t / 60, mm = t % 60, pos = hh * 6 + mm / 10;
+    HandPolygon hands[] = {
+      { HOUR_HAND[pos], HOUR_HAND_POINTS, GColorWhite, false },
+      { HOUR2_HAND[pos], HOUR2_HAND_POINTS, COLOR_FALLBACK(GColorBlue, GColorBlack), true },
+      { MINS_HAND[mm], MINS_HAND_POINTS, GColorWhite, false },
+      { MINS2_HAND[mm], MINS2_HAND_POINTS, COLOR_FALLBACK(GColorGreen, GColorBlack), true },
+    };
+    HandPolygon second = { SECS_HAND[t % 60], SECS_HAND_POINTS, GColorWhite, false };
+    const HandPolygon *polygons = secs ? &second : hands;
+    uint8_t count = secs ? 1 : ARRAY_LENGTH(hands);
+    if (raster) hand_raster_draw(ctx, bounds, center, polygons, count);
+    else gpath_draw(ctx, center, polygons, count);
+  }
+}
+
+static double bench_hands_us(bool raster, bool secs) {
+  double best = 0;
+  for (int round = 0; round < BENCH_ROUNDS; round++) {
+    uint64_t spent = 0;
+    uint32_t frames = 0;
+    while (spent < BENCH_MIN_NS) {
+      host_framebuffer_restore();
+      uint64_t start = host_time_ns();
+      draw_hands(raster, secs);
+      spent += host_time_ns() - start;
+      frames += secs ? 60 : 720;
+    }
+    double us = (double)spent / frames / 1000;
+    if (round == 0 || us < best) best = us;
+  }
+  return best;
+}
+
+// effect layer covering the benchmarked rect, consecutive per-pixel effects of it are fused into one lut pass
+static void bench_layer(GContext *ctx, GRect position, void *param) {
+  EffectLayer *effect_layer = param;
+  effect_layer_set_frame(effect_layer, position);
+  host_layer_render(effect_layer_get_layer(effect_layer));
+}
+
+// the effects of the fused layer called one after another, as a layer did before fusing
+static EffectColorpair s_chain_colorswap = { .firstColor = GColorBlack, .secondColor = GColorWhite };
+
+static void bench_chain(GContext *ctx, GRect position, void *param) {
+  effect_invert(ctx, position, NULL);
+  effect_colorswap(ctx, position, &s_chain_colorswap);
+  effect_invert_bw_only(ctx, position, NULL);
+}
+
+// white blocks and colored stripes on black, so color tests, shadows and outlines have work to do
+static void draw_test_picture(void) {
+  BitmapInfo bitmap_info;
+  bitmap_info_init(&bitmap_info, host_framebuffer());
+  BitmapRow row;
+  for (bitmap_row_begin(&row, &bitmap_info, 0); row.y < bitmap_info.bounds.size.h; bitmap_row_next(&row)) {
+    for (int x = row.min_x; x <= row.max_x; x++) {
+      bool block = ((x / 12) + (row.y / 14)) % 3 == 0;
+      uint8_t color = block ? GColorWhiteARGB8 : (x % 7 == 0 ? GColorRedARGB8 : GColorBlackARGB8);
+      if (row.one_bit) color = block ? 1 : 0;
+      bitmap_row_set(&row, x, color);
+    }
+  }
+}
+
+static double bench_ns_per_pixel(const BenchEffect *bench, GRect rect) {
+  GContext *ctx = host_context();
+  double best = 0;
+  for (int round = 0; round < BENCH_ROUNDS; round++) {
+    uint64_t spent = 0;
+    uint32_t runs = 0;
+    while (spent < BENCH_MIN_NS) {
+      host_framebuffer_restore();
+      uint64_t start = host_time_ns();
+      bench->effect(ctx, rect, bench->param);
+      spent += host_time_ns() - start;
+      runs++;
+    }
+    double ns = (double)spent / runs / (rect.size.w * rect.size.h);
+    if (round == 0 || ns < best) best = ns;
+  }
+  return best;
+}
+
+int main(void) {
+  GRect full = gbitmap_get_bounds(host_framebuffer());
+  draw_test_picture();
+  host_framebuffer_save();
+  GRect quarter = GRect(full.size.w / 4, full.size.h / 4, full.size.w / 2, full.size.h / 2);
+
+  static uint8_t lut_invert[256];
+  effect_get_lut(effect_invert, NULL, lut_invert);
+  static EffectColorpair colorize = { .firstColor = GColorWhite, .secondColor = GColorRed };
+  static EffectColorpair colorswap = { .firstColor = GColorBlack, .secondColor = GColorWhite };
+  static EffectOffset shadow = { .orig_color = GColorWhite, .offset_color = GColorRed, .offset_x = 3, .offset_y = 3 };
+  static EffectOffset long_shadow = { .orig_color = GColorWhite, .offset_color = GColorRed, .offset_x = 3, .offset_y = 3, .option = 1 };
+  static EffectOffset outline = { .orig_color = GColorWhite, .offset_color = GColorRed, .offset_x = 2, .offset_y = 2 };
+  static GColor mask_colors[] = { GColorWhite, GColorClear };
+  static EffectMask mask = { .mask_colors = mask_colors, .background_color = GColorClear };
+  mask.bitmap_background = gbitmap_create_blank(full.size, COLOR_FALLBACK(GBitmapFormat8Bit, GBitmapFormat1Bit));
+  EffectLayer *fused_layer = effect_layer_create(full);
+  effect_layer_add_effect(fused_layer, effect_invert, NULL);
+  effect_layer_add_effect(fused_layer, effect_colorswap, &s_chain_colorswap);
+  effect_layer_add_effect(fused_layer, effect_invert_bw_only, NULL);
+
+  const BenchEffect benches[] = {
+    { "invert", effect_invert, NULL },
+    { "lut", effect_lut, lut_invert },
+    { "colorize", effect_colorize, &colorize },
+    { "colorswap", effect_colorswap, &colorswap },
+    { "invert_bw_only", effect_invert_bw_only, NULL },
+    { "invert_brightness", effect_invert_brightness, NULL },
+    { "mirror_vertical", effect_mirror_vertical, NULL },
+    { "mirror_horizontal", effect_mirror_horizontal, NULL },
+    { "rotate_90_degrees", effect_rotate_90_degrees, (void *)1 },
+    { "blur(2)", effect_blur, (void *)2 },
+    { "zoom(150,60)", effect_zoom, EL_ZOOM(150, 60) },
+    { "lens(30,10)", effect_lens, EL_LENS(30, 10) },
+    { "mask", effect_mask, &mask },
+    { "shadow", effect_shadow, &shadow },
+    { "shadow(long)", effect_shadow, &long_shadow },
+    { "outline", effect_outline, &outline },
+    { "layer(3 fused)", bench_layer, fused_layer },
+  };
+
+  printf("%s %dx%d framebuffer, ns/pixel and Mpixels/s\n", HOST_PLATFORM_NAME, full.size.w, full.size.h);
+  printf("%-20s %10s %10s %10s %10s\n", "effect", "full ns", "full Mpx/s", "quarter ns", "qtr Mpx/s");
+  for (unsigned i = 0; i < ARRAY_LENGTH(benches); i++) {
+    double ns_full = bench_ns_per_pixel(&benches[i], full), ns_quarter = bench_ns_per_pixel(&benches[i], quarter);
+    printf("%-20s %10.2f %10.1f %10.2f %10.1f\n", benches[i].name, ns_full, 1e3 / ns_full, ns_quarter, 1e3 / ns_quarter);
+  }
+
+  const BenchPair pairs[] = {
+    { "invert: get/set_pixel -> BitmapRow", { "baseline", baseline_effect_invert, NULL }, { "invert", effect_invert, NULL } },
+    { "3 effects: one by one -> fused layer", { "chain", bench_chain, NULL }, { "layer", bench_layer, fused_layer } },
+  };
+
+  printf("\n%-36s %10s %10s %8s\n", "full screen, ns/pixel", "before", "after", "speedup");
+  for (unsigned i = 0; i < ARRAY_LENGTH(pairs); i++) {
+    double before = bench_ns_per_pixel(&pairs[i].before, full), after = bench_ns_per_pixel(&pairs[i].after, full);
+    printf("%-36s %10.2f %10.2f %7.1fx\n", pairs[i].name, before, after, before / after);
+  }
+
+  printf("\n%-36s %10s %10s %8s\n", "us/frame", "gpath", "raster", "speedup");
+  const char *hand_names[] = { "hour + minute hands, 4 polygons", "second hand" };
+  for (int secs = 0; secs < 2; secs++) {
+    double before = bench_hands_us(false, secs), after = bench_hands_us(true, secs);
+    printf("%-36s %10.2f %10.2f %7.1fx\n", hand_names[secs], before, after, before / after);
+  }
+
+  effect_layer_destroy(fused_layer);
+  gbitmap_destroy(mask.bitmap_background);
+  return 0;
+}
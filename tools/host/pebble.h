@@ -0,0 +1,252 @@
+// Host stand-in for the Pebble SDK header, enough to build effects.c, math.c and hand_raster.c natively.
+// Framebuffers of the three platforms are emulated in pebble_host.c.
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+typedef struct GPoint { int16_t x, y; } GPoint;
+typedef struct GSize { int16_t w, h; } GSize;
+typedef struct GRect { GPoint origin; GSize size; } GRect;
+#define GPoint(x,y) ((GPoint){(x),(y)})
+#define GSize(w,h) ((GSize){(w),(h)})
+#define GRect(x,y,w,h) ((GRect){{(x),(y)},{(w),(h)}})
+#define GRectZero GRect(0,0,0,0)
+#define GPointZero GPoint(0,0)
+typedef union GColor8 { uint8_t argb; struct { uint8_t b:2; uint8_t g:2; uint8_t r:2; uint8_t a:2; }; } GColor8;
+typedef GColor8 GColor;
+#define GColorFromHEX(x) ((GColor8){.argb=(uint8_t)(x)})
+#define GColorClearARGB8 0x00
+#define GColorClear ((GColor8){.argb=GColorClearARGB8})
+#define GColorBlackARGB8 0xC0
+#define GColorBlack ((GColor8){.argb=GColorBlackARGB8})
+#define GColorOxfordBlueARGB8 0xC1
+#define GColorOxfordBlue ((GColor8){.argb=GColorOxfordBlueARGB8})
+#define GColorDukeBlueARGB8 0xC2
+#define GColorDukeBlue ((GColor8){.argb=GColorDukeBlueARGB8})
+#define GColorBlueARGB8 0xC3
+#define GColorBlue ((GColor8){.argb=GColorBlueARGB8})
+#define GColorDarkGreenARGB8 0xC4
+#define GColorDarkGreen ((GColor8){.argb=GColorDarkGreenARGB8})
+#define GColorMidnightGreenARGB8 0xC5
+#define GColorMidnightGreen ((GColor8){.argb=GColorMidnightGreenARGB8})
+#define GColorCobaltBlueARGB8 0xC6
+#define GColorCobaltBlue ((GColor8){.argb=GColorCobaltBlueARGB8})
+#define GColorBlueMoonARGB8 0xC7
+#define GColorBlueMoon ((GColor8){.argb=GColorBlueMoonARGB8})
+#define GColorIslamicGreenARGB8 0xC8
+#define GColorIslamicGreen ((GColor8){.argb=GColorIslamicGreenARGB8})
+#define GColorJaegerGreenARGB8 0xC9
+#define GColorJaegerGreen ((GColor8){.argb=GColorJaegerGreenARGB8})
+#define GColorTiffanyBlueARGB8 0xCA
+#define GColorTiffanyBlue ((GColor8){.argb=GColorTiffanyBlueARGB8})
+#define GColorVividCeruleanARGB8 0xCB
+#define GColorVividCerulean ((GColor8){.argb=GColorVividCeruleanARGB8})
+#define GColorGreenARGB8 0xCC
+#define GColorGreen ((GColor8){.argb=GColorGreenARGB8})
+#define GColorMalachiteARGB8 0xCD
+#define GColorMalachite ((GColor8){.argb=GColorMalachiteARGB8})
+#define GColorMediumSpringGreenARGB8 0xCE
+#define GColorMediumSpringGreen ((GColor8){.argb=GColorMediumSpringGreenARGB8})
+#define GColorCyanARGB8 0xCF
+#define GColorCyan ((GColor8){.argb=GColorCyanARGB8})
+#define GColorBulgarianRoseARGB8 0xD0
+#define GColorBulgarianRose ((GColor8){.argb=GColorBulgarianRoseARGB8})
+#define GColorImperialPurpleARGB8 0xD1
+#define GColorImperialPurple ((GColor8){.argb=GColorImperialPurpleARGB8})
+#define GColorIndigoARGB8 0xD2
+#define GColorIndigo ((GColor8){.argb=GColorIndigoARGB8})
+#define GColorElectricUltramarineARGB8 0xD3
+#define GColorElectricUltramarine ((GColor8){.argb=GColorElectricUltramarineARGB8})
+#define GColorArmyGreenARGB8 0xD4
+#define GColorArmyGreen ((GColor8){.argb=GColorArmyGreenARGB8})
+#define GColorDarkGrayARGB8 0xD5
+#define GColorDarkGray ((GColor8){.argb=GColorDarkGrayARGB8})
+#define GColorLibertyARGB8 0xD6
+#define GColorLiberty ((GColor8){.argb=GColorLibertyARGB8})
+#define GColorVeryLightBlueARGB8 0xD7
+#define GColorVeryLightBlue ((GColor8){.argb=GColorVeryLightBlueARGB8})
+#define GColorKellyGreenARGB8 0xD8
+#define GColorKellyGreen ((GColor8){.argb=GColorKellyGreenARGB8})
+#define GColorMayGreenARGB8 0xD9
+#define GColorMayGreen ((GColor8){.argb=GColorMayGreenARGB8})
+#define GColorCadetBlueARGB8 0xDA
+#define GColorCadetBlue ((GColor8){.argb=GColorCadetBlueARGB8})
+#define GColorPictonBlueARGB8 0xDB
+#define GColorPictonBlue ((GColor8){.argb=GColorPictonBlueARGB8})
+#define GColorBrightGreenARGB8 0xDC
+#define GColorBrightGreen ((GColor8){.argb=GColorBrightGreenARGB8})
+#define GColorScreaminGreenARGB8 0xDD
+#define GColorScreaminGreen ((GColor8){.argb=GColorScreaminGreenARGB8})
+#define GColorMediumAquamarineARGB8 0xDE
+#define GColorMediumAquamarine ((GColor8){.argb=GColorMediumAquamarineARGB8})
+#define GColorElectricBlueARGB8 0xDF
+#define GColorElectricBlue ((GColor8){.argb=GColorElectricBlueARGB8})
+#define GColorDarkCandyAppleRedARGB8 0xE0
+#define GColorDarkCandyAppleRed ((GColor8){.argb=GColorDarkCandyAppleRedARGB8})
+#define GColorJazzberryJamARGB8 0xE1
+#define GColorJazzberryJam ((GColor8){.argb=GColorJazzberryJamARGB8})
+#define GColorPurpleARGB8 0xE2
+#define GColorPurple ((GColor8){.argb=GColorPurpleARGB8})
+#define GColorVividVioletARGB8 0xE3
+#define GColorVividViolet ((GColor8){.argb=GColorVividVioletARGB8})
+#define GColorWindsorTanARGB8 0xE4
+#define GColorWindsorTan ((GColor8){.argb=GColorWindsorTanARGB8})
+#define GColorRoseValeARGB8 0xE5
+#define GColorRoseVale ((GColor8){.argb=GColorRoseValeARGB8})
+#define GColorPurpureusARGB8 0xE6
+#define GColorPurpureus ((GColor8){.argb=GColorPurpureusARGB8})
+#define GColorLavenderIndigoARGB8 0xE7
+#define GColorLavenderIndigo ((GColor8){.argb=GColorLavenderIndigoARGB8})
+#define GColorLimerickARGB8 0xE8
+#define GColorLimerick ((GColor8){.argb=GColorLimerickARGB8})
+#define GColorBrassARGB8 0xE9
+#define GColorBrass ((GColor8){.argb=GColorBrassARGB8})
+#define GColorLightGrayARGB8 0xEA
+#define GColorLightGray ((GColor8){.argb=GColorLightGrayARGB8})
+#define GColorBabyBlueEyesARGB8 0xEB
+#define GColorBabyBlueEyes ((GColor8){.argb=GColorBabyBlueEyesARGB8})
+#define GColorSpringBudARGB8 0xEC
+#define GColorSpringBud ((GColor8){.argb=GColorSpringBudARGB8})
+#define GColorInchwormARGB8 0xED
+#define GColorInchworm ((GColor8){.argb=GColorInchwormARGB8})
+#define GColorMintGreenARGB8 0xEE
+#define GColorMintGreen ((GColor8){.argb=GColorMintGreenARGB8})
+#define GColorCelesteARGB8 0xEF
+#define GColorCeleste ((GColor8){.argb=GColorCelesteARGB8})
+#define GColorRedARGB8 0xF0
+#define GColorRed ((GColor8){.argb=GColorRedARGB8})
+#define GColorFollyARGB8 0xF1
+#define GColorFolly ((GColor8){.argb=GColorFollyARGB8})
+#define GColorFashionMagentaARGB8 0xF2
+#define GColorFashionMagenta ((GColor8){.argb=GColorFashionMagentaARGB8})
+#define GColorMagentaARGB8 0xF3
+#define GColorMagenta ((GColor8){.argb=GColorMagentaARGB8})
+#define GColorOrangeARGB8 0xF4
+#define GColorOrange ((GColor8){.argb=GColorOrangeARGB8})
+#define GColorSunsetOrangeARGB8 0xF5
+#define GColorSunsetOrange ((GColor8){.argb=GColorSunsetOrangeARGB8})
+#define GColorBrilliantRoseARGB8 0xF6
+#define GColorBrilliantRose ((GColor8){.argb=GColorBrilliantRoseARGB8})
+#define GColorShockingPinkARGB8 0xF7
+#define GColorShockingPink ((GColor8){.argb=GColorShockingPinkARGB8})
+#define GColorChromeYellowARGB8 0xF8
+#define GColorChromeYellow ((GColor8){.argb=GColorChromeYellowARGB8})
+#define GColorRajahARGB8 0xF9
+#define GColorRajah ((GColor8){.argb=GColorRajahARGB8})
+#define GColorMelonARGB8 0xFA
+#define GColorMelon ((GColor8){.argb=GColorMelonARGB8})
+#define GColorRichBrilliantLavenderARGB8 0xFB
+#define GColorRichBrilliantLavender ((GColor8){.argb=GColorRichBrilliantLavenderARGB8})
+#define GColorYellowARGB8 0xFC
+#define GColorYellow ((GColor8){.argb=GColorYellowARGB8})
+#define GColorIcterineARGB8 0xFD
+#define GColorIcterine ((GColor8){.argb=GColorIcterineARGB8})
+#define GColorPastelYellowARGB8 0xFE
+#define GColorPastelYellow ((GColor8){.argb=GColorPastelYellowARGB8})
+#define GColorWhiteARGB8 0xFF
+#define GColorWhite ((GColor8){.argb=GColorWhiteARGB8})
+bool gcolor_equal(GColor8 a, GColor8 b);
+#ifdef PBL_COLOR
+#define COLOR_FALLBACK(c,bw) (c)
+#else
+#define COLOR_FALLBACK(c,bw) (bw)
+#endif
+#ifdef PBL_ROUND
+#define PBL_IF_ROUND_ELSE(a,b) (a)
+#else
+#define PBL_IF_ROUND_ELSE(a,b) (b)
+#endif
+typedef enum { GBitmapFormat1Bit=0, GBitmapFormat8Bit, GBitmapFormat1BitPalette, GBitmapFormat2BitPalette, GBitmapFormat4BitPalette, GBitmapFormat8BitCircular } GBitmapFormat;
+typedef struct GBitmap GBitmap; typedef struct GContext GContext; typedef struct Layer Layer; typedef struct Window Window;
+typedef struct TextLayer TextLayer; typedef struct BitmapLayer BitmapLayer; typedef struct GFontS* GFont; typedef struct Animation Animation;
+typedef struct PropertyAnimation PropertyAnimation; typedef struct AppTimer AppTimer; typedef struct GPath { uint32_t num_points; GPoint* points; int32_t rotation; GPoint offset; } GPath;
+typedef struct GPathInfo { uint32_t num_points; GPoint *points; } GPathInfo;
+typedef struct { uint8_t *data; int16_t min_x; int16_t max_x; } GBitmapDataRowInfo;
+GBitmap* graphics_capture_frame_buffer(GContext*); bool graphics_release_frame_buffer(GContext*, GBitmap*);
+uint8_t* gbitmap_get_data(const GBitmap*); uint16_t gbitmap_get_bytes_per_row(const GBitmap*); GBitmapFormat gbitmap_get_format(const GBitmap*);
+GRect gbitmap_get_bounds(const GBitmap*); GBitmapDataRowInfo gbitmap_get_data_row_info(const GBitmap*, uint16_t y);
+GBitmap* gbitmap_create_blank(GSize, GBitmapFormat); GBitmap* gbitmap_create_with_resource(uint32_t); GBitmap* gbitmap_create_as_sub_bitmap(const GBitmap*, GRect); void gbitmap_destroy(GBitmap*);
+GBitmap* gbitmap_create_blank_with_palette(GSize, GBitmapFormat, GColor*, bool); GColor* gbitmap_get_palette(const GBitmap*); void gbitmap_set_palette(GBitmap*, GColor*, bool);
+void gbitmap_set_bounds(GBitmap*, GRect);
+typedef enum { GCornerNone=0 } GCornerMask;
+typedef enum { GTextOverflowModeWordWrap, GTextOverflowModeTrailingEllipsis, GTextOverflowModeFill } GTextOverflowMode;
+typedef enum { GTextAlignmentLeft, GTextAlignmentCenter, GTextAlignmentRight } GTextAlignment;
+typedef enum { GCompOpAssign, GCompOpAssignInverted, GCompOpOr, GCompOpAnd, GCompOpClear, GCompOpSet } GCompOp;
+typedef enum { GOvalScaleModeFitCircle, GOvalScaleModeFillCircle } GOvalScaleMode;
+void graphics_context_set_fill_color(GContext*, GColor); void graphics_context_set_stroke_color(GContext*, GColor); void graphics_context_set_text_color(GContext*, GColor);
+void graphics_context_set_compositing_mode(GContext*, GCompOp);
+void graphics_fill_rect(GContext*, GRect, uint16_t, GCornerMask); void graphics_draw_text(GContext*, const char*, GFont, GRect, GTextOverflowMode, GTextAlignment, void*);
+void graphics_draw_bitmap_in_rect(GContext*, const GBitmap*, GRect); void graphics_draw_line(GContext*, GPoint, GPoint);
+void graphics_fill_radial(GContext*, GRect, GOvalScaleMode, uint16_t, int32_t, int32_t); void graphics_draw_arc(GContext*, GRect, GOvalScaleMode, int32_t, int32_t);
+void graphics_draw_pixel(GContext*, GPoint);
+#define FONT_KEY_GOTHIC_14 "g14"
+GFont fonts_get_system_font(const char*); GFont fonts_load_custom_font(void*); void fonts_unload_custom_font(GFont); void* resource_get_handle(uint32_t);
+#define RESOURCE_ID_FONT_DIGITAL_24 1
+#define RESOURCE_ID_IMAGE_FACE 2
+#define RESOURCE_ID_IMAGE_BATTERY 3
+#define RESOURCE_ID_IMAGE_BATTERY_INV 4
+#define RESOURCE_ID_IMAGE_MENU 5
+#define RESOURCE_ID_IMAGE_FACE_INV 6
+uint16_t time_ms(time_t*, uint16_t*);
+typedef enum { APP_LOG_LEVEL_ERROR=1, APP_LOG_LEVEL_WARNING=50, APP_LOG_LEVEL_INFO=100, APP_LOG_LEVEL_DEBUG=200 } AppLogLevel;
+void app_log(uint8_t, const char*, int, const char*, ...);
+#define APP_LOG(level, fmt, ...) app_log(level, __FILE__, __LINE__, fmt, ## __VA_ARGS__)
+Layer* layer_create(GRect); Layer* layer_create_with_data(GRect, size_t); void* layer_get_data(const Layer*); void layer_destroy(Layer*);
+typedef void (*LayerUpdateProc)(Layer*, GContext*); void layer_set_update_proc(Layer*, LayerUpdateProc); void layer_mark_dirty(Layer*);
+void layer_add_child(Layer*, Layer*); void layer_insert_below_sibling(Layer*, Layer*); void layer_insert_above_sibling(Layer*, Layer*);
+void layer_remove_from_parent(Layer*); GRect layer_get_frame(const Layer*); GRect layer_get_bounds(const Layer*); void layer_set_frame(Layer*, GRect); void layer_set_hidden(Layer*, bool); bool layer_get_hidden(const Layer*);
+void layer_mark_dirty_rect(Layer*, GRect);
+GPoint grect_center_point(const GRect*);
+int16_t grect_get_max_x(const GRect *r); int16_t grect_get_max_y(const GRect *r);
+bool grect_equal(const GRect*, const GRect*);
+#define TRIG_MAX_ANGLE 0x10000
+#define TRIG_MAX_RATIO 0xffff
+#define DEG_TO_TRIGANGLE(a) (((a) * TRIG_MAX_ANGLE) / 360)
+int32_t sin_lookup(int32_t); int32_t cos_lookup(int32_t); int32_t atan2_lookup(int16_t, int16_t);
+GPath* gpath_create(const GPathInfo*); void gpath_destroy(GPath*); void gpath_move_to(GPath*, GPoint); void gpath_rotate_to(GPath*, int32_t);
+void gpath_draw_filled(GContext*, GPath*); void gpath_draw_outline(GContext*, GPath*);
+typedef struct { const uint32_t *durations; uint32_t num_segments; } VibePattern; void vibes_enqueue_custom_pattern(VibePattern);
+#define ARRAY_LENGTH(a) (sizeof(a)/sizeof(a[0]))
+typedef enum { SECOND_UNIT=1, MINUTE_UNIT=2, HOUR_UNIT=4, DAY_UNIT=8, MONTH_UNIT=16, YEAR_UNIT=32 } TimeUnits;
+typedef void (*TickHandler)(struct tm*, TimeUnits); void tick_timer_service_subscribe(TimeUnits, TickHandler); void tick_timer_service_unsubscribe(void);
+typedef void (*AppTimerCallback)(void*); AppTimer* app_timer_register(uint32_t, AppTimerCallback, void*); void app_timer_cancel(AppTimer*); bool app_timer_reschedule(AppTimer*, uint32_t);
+typedef struct { uint8_t charge_percent; bool is_charging; bool is_plugged; } BatteryChargeState;
+typedef void (*BatteryStateHandler)(BatteryChargeState); void battery_state_service_subscribe(BatteryStateHandler); void battery_state_service_unsubscribe(void); BatteryChargeState battery_state_service_peek(void);
+typedef void (*BluetoothConnectionHandler)(bool); void bluetooth_connection_service_subscribe(BluetoothConnectionHandler); void bluetooth_connection_service_unsubscribe(void); bool bluetooth_connection_service_peek(void);
+bool clock_is_24h_style(void);
+void text_layer_set_text(TextLayer*, const char*); TextLayer* text_layer_create(GRect); void text_layer_destroy(TextLayer*); void text_layer_set_text_color(TextLayer*, GColor);
+void text_layer_set_background_color(TextLayer*, GColor); void text_layer_set_text_alignment(TextLayer*, GTextAlignment); void text_layer_set_font(TextLayer*, GFont); Layer* text_layer_get_layer(TextLayer*);
+BitmapLayer* bitmap_layer_create(GRect); void bitmap_layer_destroy(BitmapLayer*); void bitmap_layer_set_bitmap(BitmapLayer*, const GBitmap*); const GBitmap* bitmap_layer_get_bitmap(BitmapLayer*);
+void bitmap_layer_set_background_color(BitmapLayer*, GColor); Layer* bitmap_layer_get_layer(const BitmapLayer*); void bitmap_layer_set_compositing_mode(BitmapLayer*, GCompOp);
+typedef enum { AnimationCurveLinear, AnimationCurveEaseIn, AnimationCurveEaseOut, AnimationCurveEaseInOut } AnimationCurve;
+#define ANIMATION_NORMALIZED_MIN 0
+#define ANIMATION_NORMALIZED_MAX 65535
+typedef uint32_t AnimationProgress;
+typedef void (*AnimationSetupImplementation)(Animation*); typedef void (*AnimationUpdateImplementation)(Animation*, const AnimationProgress); typedef void (*AnimationTeardownImplementation)(Animation*);
+typedef struct { AnimationSetupImplementation setup; AnimationUpdateImplementation update; AnimationTeardownImplementation teardown; } AnimationImplementation;
+typedef void (*AnimationStartedHandler)(Animation*, void*); typedef void (*AnimationStoppedHandler)(Animation*, bool, void*);
+typedef struct { AnimationStartedHandler started; AnimationStoppedHandler stopped; } AnimationHandlers;
+Animation* animation_create(void); bool animation_destroy(Animation*); bool animation_set_implementation(Animation*, const AnimationImplementation*); bool animation_set_handlers(Animation*, AnimationHandlers, void*);
+void* animation_get_context(Animation*);
+bool animation_set_curve(Animation*, AnimationCurve); bool animation_set_delay(Animation*, uint32_t); bool animation_set_duration(Animation*, uint32_t); bool animation_schedule(Animation*); bool animation_unschedule(Animation*);
+Animation* animation_spawn_create(Animation*, ...); Animation* animation_spawn_create_from_array(Animation**, uint32_t);
+bool animation_is_scheduled(Animation*);
+PropertyAnimation* property_animation_create_layer_frame(Layer*, GRect*, GRect*); void property_animation_destroy(PropertyAnimation*); Animation* property_animation_get_animation(PropertyAnimation*);
+Window* window_create(void); void window_destroy(Window*); typedef void (*WindowHandler)(Window*); typedef struct { WindowHandler load, appear, disappear, unload; } WindowHandlers;
+void window_set_window_handlers(Window*, WindowHandlers); Layer* window_get_root_layer(const Window*); void window_set_background_color(Window*, GColor); void window_stack_push(Window*, bool);
+bool persist_exists(uint32_t); bool persist_read_bool(uint32_t); int32_t persist_read_int(uint32_t); int persist_read_data(uint32_t, void*, size_t);
+int persist_write_bool(uint32_t, bool); int persist_write_int(uint32_t, int32_t); int persist_write_data(uint32_t, const void*, size_t); int persist_delete(uint32_t);
+typedef enum { APP_MSG_OK=0 } AppMessageResult;
+typedef enum { TUPLE_BYTE_ARRAY=0, TUPLE_CSTRING=1, TUPLE_UINT=2, TUPLE_INT=3 } TupleType;
+typedef struct { uint32_t key; TupleType type:8; uint16_t length; union { uint8_t data[0]; char cstring[0]; uint8_t uint8; uint16_t uint16; uint32_t uint32; int8_t int8; int16_t int16; int32_t int32; } value[]; } Tuple;
+typedef struct DictionaryIterator DictionaryIterator;
+Tuple* dict_read_first(DictionaryIterator*); Tuple* dict_read_next(DictionaryIterator*); Tuple* dict_find(const DictionaryIterator*, uint32_t);
+typedef void (*AppMessageInboxReceived)(DictionaryIterator*, void*); typedef void (*AppMessageInboxDropped)(AppMessageResult, void*);
+void app_message_register_inbox_received(AppMessageInboxReceived); void app_message_register_inbox_dropped(AppMessageInboxDropped); AppMessageResult app_message_open(uint32_t, uint32_t); void app_message_deregister_callbacks(void);
+#define dict_calc_buffer_size(n, ...) (1 + (n)*7 + 64)
+uint32_t dict_calc_buffer_size_from_tuplets(void*, uint8_t);
+void app_event_loop(void);
@@ -0,0 +1,227 @@
+#include "pebble_host.h"
+
+struct GBitmap {
+  uint8_t *data;
+  uint16_t bytes_per_row;
+  GBitmapFormat format;
+  GRect bounds;
+  int16_t *min_x, *max_x; // visible span of every row (circular bitmaps)
+  uint32_t *row_offset;   // offset of every row in data (circular bitmaps)
+  size_t data_size;
+};
+
+struct GContext {
+  GBitmap *fb;
+};
+
+// effect_layer.c finds the parent pointer by scanning the first pointer-sized fields of a Layer
+struct Layer {
+  GRect frame;
+  GRect bounds;
+  struct Layer *parent;
+  struct Layer *first_child;
+  struct Layer *next_sibling;
+  LayerUpdateProc update_proc;
+  bool hidden;
+  size_t data_size; // layer data follows the struct
+};
+
+static GBitmap *bitmap_create(GSize size, GBitmapFormat format) {
+  GBitmap *bitmap = calloc(1, sizeof(GBitmap));
+  bitmap->format = format;
+  bitmap->bounds = GRect(0, 0, size.w, size.h);
+
+  switch (format) {
+    case GBitmapFormat1Bit: bitmap->bytes_per_row = (size.w + 31) / 32 * 4; break; // rows are word aligned
+    case GBitmapFormat1BitPalette: bitmap->bytes_per_row = (size.w + 7) / 8; break;
+    case GBitmapFormat2BitPalette: bitmap->bytes_per_row = (size.w + 3) / 4; break;
+    case GBitmapFormat4BitPalette: bitmap->bytes_per_row = (size.w + 1) / 2; break;
+    default: bitmap->bytes_per_row = size.w; break;
+  }
+
+  if (format != GBitmapFormat8BitCircular) {
+    bitmap->data_size = bitmap->bytes_per_row * size.h;
+    bitmap->data = calloc(bitmap->data_size, 1);
+    return bitmap;
+  }
+
+  // only pixels inside the circle are stored, one row after another
+  bitmap->bytes_per_row = 0;
+  bitmap->min_x = malloc(size.h * sizeof(int16_t));
+  bitmap->max_x = malloc(size.h * sizeof(int16_t));
+  bitmap->row_offset = malloc(size.h * sizeof(uint32_t));
+  uint32_t total = 0;
+  for (int y = 0; y < size.h; y++) {
+    int dy = 2 * y + 1 - size.h, r2 = size.w * size.w - dy * dy, dx = 0;
+    while ((2 * dx + 2) * (2 * dx + 2) <= r2) dx++;
+    bitmap->min_x[y] = size.w / 2 - dx;
+    bitmap->max_x[y] = size.w / 2 + dx - 1;
+    bitmap->row_offset[y] = total;
+    total += 2 * dx;
+  }
+  bitmap->data_size = total;
+  bitmap->data = calloc(total, 1);
+  return bitmap;
+}
+
+GBitmap *host_framebuffer(void) {
+  static GBitmap *fb;
+  if (!fb) {
+#if defined(PBL_PLATFORM_APLITE)
+    fb = bitmap_create(GSize(144, 168), GBitmapFormat1Bit);
+#elif defined(PBL_PLATFORM_CHALK)
+    fb = bitmap_create(GSize(180, 180), GBitmapFormat8BitCircular);
+#else
+    fb = bitmap_create(GSize(144, 168), GBitmapFormat8Bit);
+#endif
+  }
+  return fb;
+}
+
+GContext *host_context(void) {
+  static GContext ctx;
+  ctx.fb = host_framebuffer();
+  return &ctx;
+}
+
+static uint8_t *s_saved_fb;
+
+void host_framebuffer_save(void) {
+  GBitmap *fb = host_framebuffer();
+  if (!s_saved_fb) s_saved_fb = malloc(fb->data_size);
+  memcpy(s_saved_fb, fb->data, fb->data_size);
+}
+
+void host_framebuffer_restore(void) {
+  GBitmap *fb = host_framebuffer();
+  if (s_saved_fb) memcpy(fb->data, s_saved_fb, fb->data_size);
+}
+
+uint64_t host_time_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+// bitmaps
+
+GBitmap *gbitmap_create_blank(GSize size, GBitmapFormat format) {
+  return bitmap_create(size, format);
+}
+
+void gbitmap_destroy(GBitmap *bitmap) {
+  if (!bitmap) return;
+  free(bitmap->data);
+  free(bitmap->min_x);
+  free(bitmap->max_x);
+  free(bitmap->row_offset);
+  free(bitmap);
+}
+
+uint8_t *gbitmap_get_data(const GBitmap *bitmap) { return bitmap->data; }
+uint16_t gbitmap_get_bytes_per_row(const GBitmap *bitmap) { return bitmap->bytes_per_row; }
+GBitmapFormat gbitmap_get_format(const GBitmap *bitmap) { return bitmap->format; }
+GRect gbitmap_get_bounds(const GBitmap *bitmap) { return bitmap->bounds; }
+
+GBitmapDataRowInfo gbitmap_get_data_row_info(const GBitmap *bitmap, uint16_t y) {
+  GBitmapDataRowInfo info;
+  if (bitmap->format != GBitmapFormat8BitCircular) {
+    info.data = bitmap->data + y * bitmap->bytes_per_row;
+    info.min_x = bitmap->bounds.origin.x;
+    info.max_x = bitmap->bounds.origin.x + bitmap->bounds.size.w - 1;
+    return info;
+  }
+  // as in the firmware data points at pixel 0 of the row, only min_x..max_x may be accessed
+  info.data = bitmap->data + bitmap->row_offset[y] - bitmap->min_x[y];
+  info.min_x = bitmap->min_x[y];
+  info.max_x = bitmap->max_x[y];
+  return info;
+}
+
+// graphics
+
+GBitmap *graphics_capture_frame_buffer(GContext *ctx) { return ctx->fb; }
+bool graphics_release_frame_buffer(GContext *ctx, GBitmap *bitmap) { return true; }
+
+GPoint grect_center_point(const GRect *rect) {
+  return GPoint(rect->origin.x + rect->size.w / 2, rect->origin.y + rect->size.h / 2);
+}
+
+bool gcolor_equal(GColor8 a, GColor8 b) {
+  return a.argb == b.argb || (a.a == 0 && b.a == 0);
+}
+
+// drawing through the graphics context is not emulated, effects using it (mask, fps) only pay for their own work
+void graphics_context_set_fill_color(GContext *ctx, GColor color) {}
+void graphics_context_set_stroke_color(GContext *ctx, GColor color) {}
+void graphics_context_set_text_color(GContext *ctx, GColor color) {}
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t radius, GCornerMask mask) {}
+void graphics_draw_text(GContext *ctx, const char *text, GFont font, GRect box, GTextOverflowMode overflow, GTextAlignment alignment, void *attributes) {}
+void graphics_draw_bitmap_in_rect(GContext *ctx, const GBitmap *bitmap, GRect rect) {}
+GFont fonts_get_system_font(const char *key) { return NULL; }
+
+// layers
+
+Layer *layer_create_with_data(GRect frame, size_t data_size) {
+  Layer *layer = calloc(1, sizeof(Layer) + data_size);
+  layer->frame = frame;
+  layer->bounds = GRect(0, 0, frame.size.w, frame.size.h);
+  layer->data_size = data_size;
+  return layer;
+}
+
+Layer *layer_create(GRect frame) {
+  return layer_create_with_data(frame, 0);
+}
+
+void layer_remove_from_parent(Layer *child) {
+  if (!child->parent) return;
+  Layer **link = &child->parent->first_child;
+  while (*link && *link != child) link = &(*link)->next_sibling;
+  if (*link) *link = child->next_sibling;
+  child->parent = NULL;
+  child->next_sibling = NULL;
+}
+
+void layer_destroy(Layer *layer) {
+  if (!layer) return;
+  layer_remove_from_parent(layer);
+  for (Layer *child = layer->first_child; child; child = child->next_sibling) child->parent = NULL;
+  free(layer);
+}
+
+void layer_add_child(Layer *parent, Layer *child) {
+  layer_remove_from_parent(child);
+  Layer **link = &parent->first_child;
+  while (*link) link = &(*link)->next_sibling;
+  *link = child;
+  child->parent = parent;
+}
+
+void *layer_get_data(const Layer *layer) { return (void *)(layer + 1); }
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc) { layer->update_proc = update_proc; }
+GRect layer_get_frame(const Layer *layer) { return layer->frame; }
+GRect layer_get_bounds(const Layer *layer) { return layer->bounds; }
+
+void layer_set_frame(Layer *layer, GRect frame) {
+  layer->frame = frame;
+  layer->bounds.size = frame.size;
+}
+
+void layer_mark_dirty(Layer *layer) {}
+
+void host_layer_render(Layer *layer) {
+  if (layer->update_proc && !layer->hidden) layer->update_proc(layer, host_context());
+}
+
+// time and logging
+
+uint16_t time_ms(time_t *t, uint16_t *ms) {
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  if (t) *t = ts.tv_sec;
+  if (ms) *ms = ts.tv_nsec / 1000000;
+  return ts.tv_nsec / 1000000;
+}
+
+void app_log(uint8_t level, const char *file, int line, const char *fmt, ...) {}
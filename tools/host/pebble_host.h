@@ -0,0 +1,22 @@
+// Host side of the harness: a framebuffer laid out as on the platform selected by PBL_PLATFORM_*
+//   Aplite - GBitmapFormat1Bit 144x168, 20 bytes per row, LSB is the leftmost pixel
+//   Basalt - GBitmapFormat8Bit 144x168
+//   Chalk  - GBitmapFormat8BitCircular 180x180, rows packed to the visible circle (gbitmap_get_data_row_info)
+#pragma once
+#include <pebble.h>
+
+#define HOST_PLATFORM_NAME PBL_IF_ROUND_ELSE("chalk", COLOR_FALLBACK("basalt", "aplite"))
+
+// context drawing into the emulated framebuffer
+GContext *host_context(void);
+GBitmap *host_framebuffer(void);
+
+// keeps a copy of the framebuffer content / puts the copy back
+void host_framebuffer_save(void);
+void host_framebuffer_restore(void);
+
+// runs the update proc of the layer on host_context (children are not drawn)
+void host_layer_render(Layer *layer);
+
+// monotonic clock in ns
+uint64_t host_time_ns(void);
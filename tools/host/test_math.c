@@ -0,0 +1,146 @@
+// Checks the fixed point functions of src/math.c against libm over their whole input range and times them
+// next to the float versions they replace. Exits non-zero if an error bound is exceeded.
+#include <math.h>
+#undef M_PI // src/math.h has its own
+#include "pebble_host.h"
+#include "../../src/math.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_CYCLES 1
+#endif
+
+// max errors allowed, in LSB of the result (Q16 for ratios, TRIG_MAX_ANGLE units for angles)
+#define SIN_MAX_LSB 2.0
+#define TAN_MAX_LSB 3.0 // |tan| <= 1
+#define TAN_MAX_REL 0.002 // 1 <= |tan| <= 64 (within about 0.9 degrees of +-90)
+#define ASIN_MAX_LSB 3.5
+#define SQRT_MAX_LSB 1.0 // result is floor of the exact root
+
+#define ANGLE_TO_RAD(a) ((a) * 2 * M_PI / TRIG_MAX_ANGLE)
+
+static int s_failures;
+
+static void check(const char *name, double err, double bound, const char *unit) {
+  bool ok = err <= bound;
+  printf("%-6s max error %10.4f %-4s (bound %g) %s\n", name, err, unit, bound, ok ? "ok" : "FAIL");
+  if (!ok) s_failures++;
+}
+
+static void test_sin_cos_tan(void) {
+  double err_sin = 0, err_cos = 0, err_tan = 0, rel_tan = 0;
+  // two periods either side of zero, then the rest of the int32 range must repeat the first period
+  for (int32_t a = -2 * TRIG_MAX_ANGLE; a < 2 * TRIG_MAX_ANGLE; a++) {
+    double r = ANGLE_TO_RAD(a);
+    int32_t s, c;
+    fx_sincos(a, &s, &c);
+    if (s != fx_sin(a) || c != fx_cos(a)) {
+      printf("fx_sincos(%d) = %d, %d differs from fx_sin %d / fx_cos %d\n", a, s, c, fx_sin(a), fx_cos(a));
+      s_failures++;
+      return;
+    }
+    err_sin = fmax(err_sin, fabs(s - sin(r) * FX_ONE));
+    err_cos = fmax(err_cos, fabs(c - cos(r) * FX_ONE));
+
+    double t = tan(r);
+    if (fabs(t) <= 1) err_tan = fmax(err_tan, fabs(fx_tan(a) - t * FX_ONE));
+    else if (fabs(t) <= 64) rel_tan = fmax(rel_tan, fabs(fx_tan(a) / (t * FX_ONE) - 1));
+  }
+  for (int64_t a = INT32_MIN; a <= INT32_MAX; a += 65521) {
+    if (fx_sin(a) != fx_sin(a & 0xFFFF) || fx_cos(a) != fx_cos(a & 0xFFFF)) {
+      printf("fx_sin/fx_cos(%lld) not periodic\n", (long long)a);
+      s_failures++;
+      break;
+    }
+  }
+  if (fx_tan(TRIG_MAX_ANGLE / 4) != INT32_MAX || fx_tan(-TRIG_MAX_ANGLE / 4) != -INT32_MAX) {
+    printf("fx_tan does not saturate at +-90 degrees\n");
+    s_failures++;
+  }
+
+  check("sin", err_sin, SIN_MAX_LSB, "LSB");
+  check("cos", err_cos, SIN_MAX_LSB, "LSB");
+  check("tan", err_tan, TAN_MAX_LSB, "LSB");
+  check("tan", rel_tan, TAN_MAX_REL, "rel");
+}
+
+static void test_asin_acos(void) {
+  double err_asin = 0, err_acos = 0;
+  for (int32_t x = -FX_ONE; x <= FX_ONE; x++) {
+    double v = (double)x / FX_ONE;
+    err_asin = fmax(err_asin, fabs(fx_asin(x) - asin(v) * TRIG_MAX_ANGLE / (2 * M_PI)));
+    err_acos = fmax(err_acos, fabs(fx_acos(x) - acos(v) * TRIG_MAX_ANGLE / (2 * M_PI)));
+  }
+  // out of range ratios are clamped
+  if (fx_asin(2 * FX_ONE) != fx_asin(FX_ONE) || fx_asin(INT32_MIN + 1) != fx_asin(-FX_ONE) ||
+      fx_asin(INT32_MIN) != fx_asin(-FX_ONE) || fx_acos(INT32_MIN) != fx_acos(-FX_ONE)) {
+    printf("fx_asin does not clamp its input\n");
+    s_failures++;
+  }
+
+  check("asin", err_asin, ASIN_MAX_LSB, "LSB");
+  check("acos", err_acos, ASIN_MAX_LSB, "LSB");
+}
+
+static double sqrt_error(uint32_t x) {
+  return fabs(fx_sqrt(x) - sqrt((double)x * FX_ONE));
+}
+
+static void test_sqrt(void) {
+  double err = 0;
+  // every input up to 2^24, then a prime stride and the top of the range
+  for (uint32_t x = 0; x < (1u << 24); x++) err = fmax(err, sqrt_error(x));
+  for (uint64_t x = 1u << 24; x <= UINT32_MAX; x += 4099) err = fmax(err, sqrt_error(x));
+  for (uint32_t x = UINT32_MAX - 4096; x != 0; x++) err = fmax(err, sqrt_error(x));
+
+  check("sqrt", err, SQRT_MAX_LSB, "LSB");
+}
+
+// timing
+
+#define TIME_CALLS 2000000
+
+static volatile int32_t s_sink_i;
+static volatile float s_sink_f;
+
+static uint64_t cycles(void) {
+#ifdef HAVE_CYCLES
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+#define TIME(name, expr) do { \
+    uint64_t t0 = host_time_ns(), c0 = cycles(); \
+    for (int32_t i = 0; i < TIME_CALLS; i++) { expr; } \
+    uint64_t c1 = cycles(), t1 = host_time_ns(); \
+    printf("%-10s %8.2f ns %8.1f cycles\n", name, (double)(t1 - t0) / TIME_CALLS, (double)(c1 - c0) / TIME_CALLS); \
+  } while (0)
+
+static void time_functions(void) {
+  // the host has an FPU, on the watch the float versions go through soft float and cost far more
+  printf("\nper call on this host%s\n", cycles() ? " (cycles from the time stamp counter)" : " (no cycle counter)");
+  TIME("fx_sin", s_sink_i = fx_sin(i));
+  TIME("my_sin", s_sink_f = my_sin(i * 1e-4f));
+  TIME("fx_cos", s_sink_i = fx_cos(i));
+  TIME("my_cos", s_sink_f = my_cos(i * 1e-4f));
+  TIME("fx_tan", s_sink_i = fx_tan(i));
+  TIME("my_tan", s_sink_f = my_tan(i * 1e-4f));
+  TIME("fx_asin", s_sink_i = fx_asin(i & 0x1FFFF) - FX_ONE);
+  TIME("my_asin", s_sink_f = my_asin((i & 0x1FFFF) / 65536.0f - 1));
+  TIME("fx_acos", s_sink_i = fx_acos(i & 0x1FFFF) - FX_ONE);
+  TIME("my_acos", s_sink_f = my_acos((i & 0x1FFFF) / 65536.0f - 1));
+  TIME("fx_sqrt", s_sink_i = fx_sqrt((uint32_t)i * 2003u));
+  TIME("my_sqrt", s_sink_f = my_sqrt(i * 0.03f));
+}
+
+int main(void) {
+  test_sin_cos_tan();
+  test_asin_acos();
+  test_sqrt();
+  time_functions();
+
+  if (s_failures) printf("\n%d check(s) failed\n", s_failures);
+  return s_failures ? 1 : 0;
+}